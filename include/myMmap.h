@@ -0,0 +1 @@
+../src/util/myMmap.h
\ No newline at end of file
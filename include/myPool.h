@@ -0,0 +1 @@
+../src/util/myPool.h
\ No newline at end of file
@@ -0,0 +1,74 @@
+cirAig.o: cirAig.cpp cirMgr.h cirDef.h ../../include/myHashMap.h \
+ cirGate.h ../../include/sat.h ../../include/Solver.h \
+ ../../include/SolverTypes.h ../../include/Global.h \
+ ../../include/VarOrder.h ../../include/Heap.h ../../include/Proof.h \
+ ../../include/File.h ../../include/myMmap.h ../../include/myPool.h \
+ ../../include/myThread.h
+cirCmd.o: cirCmd.cpp cirMgr.h cirDef.h ../../include/myHashMap.h \
+ cirGate.h ../../include/sat.h ../../include/Solver.h \
+ ../../include/SolverTypes.h ../../include/Global.h \
+ ../../include/VarOrder.h ../../include/Heap.h ../../include/Proof.h \
+ ../../include/File.h ../../include/myMmap.h ../../include/myPool.h \
+ ../../include/myThread.h cirCmd.h ../../include/cmdParser.h \
+ ../../include/cmdCharDef.h ../../include/util.h ../../include/rnGen.h \
+ ../../include/myUsage.h
+cirFault.o: cirFault.cpp cirMgr.h cirDef.h ../../include/myHashMap.h \
+ cirGate.h ../../include/sat.h ../../include/Solver.h \
+ ../../include/SolverTypes.h ../../include/Global.h \
+ ../../include/VarOrder.h ../../include/Heap.h ../../include/Proof.h \
+ ../../include/File.h ../../include/myMmap.h ../../include/myPool.h \
+ ../../include/myThread.h
+cirFec.o: cirFec.cpp cirMgr.h cirDef.h ../../include/myHashMap.h \
+ cirGate.h ../../include/sat.h ../../include/Solver.h \
+ ../../include/SolverTypes.h ../../include/Global.h \
+ ../../include/VarOrder.h ../../include/Heap.h ../../include/Proof.h \
+ ../../include/File.h ../../include/myMmap.h ../../include/myPool.h \
+ ../../include/myThread.h
+cirFraig.o: cirFraig.cpp cirMgr.h cirDef.h ../../include/myHashMap.h \
+ cirGate.h ../../include/sat.h ../../include/Solver.h \
+ ../../include/SolverTypes.h ../../include/Global.h \
+ ../../include/VarOrder.h ../../include/Heap.h ../../include/Proof.h \
+ ../../include/File.h ../../include/myMmap.h ../../include/myPool.h \
+ ../../include/myThread.h ../../include/util.h ../../include/rnGen.h \
+ ../../include/myUsage.h
+cirGate.o: cirGate.cpp cirGate.h cirDef.h ../../include/myHashMap.h \
+ ../../include/sat.h ../../include/Solver.h ../../include/SolverTypes.h \
+ ../../include/Global.h ../../include/VarOrder.h ../../include/Heap.h \
+ ../../include/Proof.h ../../include/File.h cirMgr.h \
+ ../../include/myMmap.h ../../include/myPool.h ../../include/myThread.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
+cirMgr.o: cirMgr.cpp cirMgr.h cirDef.h ../../include/myHashMap.h \
+ cirGate.h ../../include/sat.h ../../include/Solver.h \
+ ../../include/SolverTypes.h ../../include/Global.h \
+ ../../include/VarOrder.h ../../include/Heap.h ../../include/Proof.h \
+ ../../include/File.h ../../include/myMmap.h ../../include/myPool.h \
+ ../../include/myThread.h ../../include/util.h ../../include/rnGen.h \
+ ../../include/myUsage.h
+cirOpt.o: cirOpt.cpp cirMgr.h cirDef.h ../../include/myHashMap.h \
+ cirGate.h ../../include/sat.h ../../include/Solver.h \
+ ../../include/SolverTypes.h ../../include/Global.h \
+ ../../include/VarOrder.h ../../include/Heap.h ../../include/Proof.h \
+ ../../include/File.h ../../include/myMmap.h ../../include/myPool.h \
+ ../../include/myThread.h ../../include/util.h ../../include/rnGen.h \
+ ../../include/myUsage.h
+cirSave.o: cirSave.cpp cirMgr.h cirDef.h ../../include/myHashMap.h \
+ cirGate.h ../../include/sat.h ../../include/Solver.h \
+ ../../include/SolverTypes.h ../../include/Global.h \
+ ../../include/VarOrder.h ../../include/Heap.h ../../include/Proof.h \
+ ../../include/File.h ../../include/myMmap.h ../../include/myPool.h \
+ ../../include/myThread.h ../../include/util.h ../../include/rnGen.h \
+ ../../include/myUsage.h
+cirSim.o: cirSim.cpp cirMgr.h cirDef.h ../../include/myHashMap.h \
+ cirGate.h ../../include/sat.h ../../include/Solver.h \
+ ../../include/SolverTypes.h ../../include/Global.h \
+ ../../include/VarOrder.h ../../include/Heap.h ../../include/Proof.h \
+ ../../include/File.h ../../include/myMmap.h ../../include/myPool.h \
+ ../../include/myThread.h ../../include/util.h ../../include/rnGen.h \
+ ../../include/myUsage.h
+cirWeight.o: cirWeight.cpp cirMgr.h cirDef.h ../../include/myHashMap.h \
+ cirGate.h ../../include/sat.h ../../include/Solver.h \
+ ../../include/SolverTypes.h ../../include/Global.h \
+ ../../include/VarOrder.h ../../include/Heap.h ../../include/Proof.h \
+ ../../include/File.h ../../include/myMmap.h ../../include/myPool.h \
+ ../../include/myThread.h ../../include/util.h ../../include/rnGen.h \
+ ../../include/myUsage.h
@@ -0,0 +1 @@
+cir.d: 
@@ -0,0 +1,110 @@
+/****************************************************************************
+  FileName     [ cirAig.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the dense (structure-of-arrays) AIG view ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include "cirMgr.h"
+#include "cirGate.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+// The CirGate graph is what the parser and the structural commands
+// (CIRSWeep, CIROPTimize, CIRSTRash, CIRFraig merges, CIRPrint, ...)
+// work on. The hot loops (simulation, strash hashing and the fraig CNF)
+// read a dense, gateId-indexed copy of it instead:
+//
+//    _aigType[gid]            GateType, or TOT_GATE if there is no gate
+//    _aigFanin[2*gid + i]     fanin i as a literal (fanin gateId*2 + inv)
+//    _aigFanout[_aigFoOffset[gid] .. _aigFoOffset[gid+1]-1]
+//                             fanouts as literals (fanout gateId*2 + inv)
+//    _aigOrder                AIG gateIds in netList (topological) order
+//    _aigLevel[gid]           logic level; PIs, CONST and UNDEF gates,
+//                             POs and AIGs not in netList are level 0
+//    _aigLevelOrder[_aigLevelOffset[l] .. _aigLevelOffset[l+1]-1]
+//                             AIG gateIds of logic level l+1
+//
+// The view is rebuilt lazily (syncAig()) after netList is regenerated or
+// gates are removed.
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+
+/*********************************************/
+/*   Public member functions about AIG view  */
+/*********************************************/
+void
+CirMgr::buildAig()
+{
+   size_t n = MILOA[0] + MILOA[3] + 1;
+   _aigType.assign(n, TOT_GATE);
+   _aigFanin.assign(2 * n, 0);
+   _aigFoOffset.assign(n + 1, 0);
+
+   for (const CirGate *g : CirCuit) {
+      unsigned gid = g->gateId;
+      assert(gid < n);
+      _aigType[gid] = g->gateType;
+      for (size_t i = 0, m = g->fanIn.size(); i < m; ++i) {
+         unsigned fid = g->fanIn[i]->gateId;
+         _aigFanin[2 * gid + i] = 2 * fid + g->fanIn_inv[i];
+         ++_aigFoOffset[fid + 1];
+      }
+   }
+
+   // CSR fanout index from the fanin literals
+   for (size_t i = 0; i < n; ++i)
+      _aigFoOffset[i + 1] += _aigFoOffset[i];
+   _aigFanout.resize(_aigFoOffset[n]);
+   vector<unsigned> pos(_aigFoOffset.begin(), _aigFoOffset.end() - 1);
+   for (const CirGate *g : CirCuit) {
+      unsigned gid = g->gateId;
+      for (size_t i = 0, m = g->fanIn.size(); i < m; ++i) {
+         unsigned lit = _aigFanin[2 * gid + i];
+         _aigFanout[pos[lit >> 1]++] = 2 * gid + (lit & 1);
+      }
+   }
+
+   _aigOrder.clear();
+   _aigOrder.reserve(MILOA[4]);
+   for (const CirGate *g : netList)
+      if (g->gateType == AIG_GATE)
+         _aigOrder.push_back(g->gateId);
+
+   // levels from the topological order, then a counting sort by level
+   vector<unsigned>& level = _aigLevel;
+   level.assign(n, 0);
+   unsigned maxLevel = 0;
+   for (unsigned gid : _aigOrder) {
+      unsigned la = level[_aigFanin[2 * gid] >> 1];
+      unsigned lb = level[_aigFanin[2 * gid + 1] >> 1];
+      level[gid] = (la > lb? la: lb) + 1;
+      if (level[gid] > maxLevel) maxLevel = level[gid];
+   }
+   _aigLevelOffset.assign(maxLevel + 1, 0);
+   for (unsigned gid : _aigOrder)
+      ++_aigLevelOffset[level[gid]];
+   for (unsigned l = 0; l < maxLevel; ++l)
+      _aigLevelOffset[l + 1] += _aigLevelOffset[l];
+   _aigLevelOrder.resize(_aigOrder.size());
+   for (size_t i = _aigOrder.size(); i-- > 0; ) {
+      unsigned gid = _aigOrder[i];
+      _aigLevelOrder[--_aigLevelOffset[level[gid]]] = gid;
+   }
+   // _aigLevelOffset[l] now starts level l; drop the empty level 0
+   _aigLevelOffset.erase(_aigLevelOffset.begin());
+   _aigLevelOffset.push_back(_aigOrder.size());
+
+   // the simulation values no longer match the previous PI words, and
+   // the fault simulation state is sized for the old gates
+   _simPiPrev.clear();
+   _faultWork.clear();
+   _aigDirty = false;
+}
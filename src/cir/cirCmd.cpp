@@ -9,6 +9,8 @@
 #include <cassert>
 #include <iostream>
 #include <iomanip>
+#include <ctime>
+#include <unistd.h>
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "cirCmd.h"
@@ -30,7 +32,10 @@ initCirCmd()
          cmdMgr->regCmd("CIRSTRash", 6, new CirStrashCmd) &&
          cmdMgr->regCmd("CIRSIMulate", 6, new CirSimCmd) &&
          cmdMgr->regCmd("CIRFraig", 4, new CirFraigCmd) &&
-         cmdMgr->regCmd("CIRWrite", 4, new CirWriteCmd)
+         cmdMgr->regCmd("CIRWrite", 4, new CirWriteCmd) &&
+         cmdMgr->regCmd("CIRSAve", 5, new CirSaveCmd) &&
+         cmdMgr->regCmd("CIRLoad", 4, new CirLoadCmd) &&
+         cmdMgr->regCmd("CIRPAck", 5, new CirPackCmd)
       )) {
       cerr << "Registering \"cir\" commands fails... exiting" << endl;
       return false;
@@ -54,7 +59,7 @@ enum CirCmdState
 static CirCmdState curCmd = CIRINIT;
 
 //----------------------------------------------------------------------
-//    CIRRead <(string fileName)> [-Replace]
+//    CIRRead <(string fileName)> [-Replace] [-Verbose]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirReadCmd::exec(const string& option)
@@ -66,13 +71,17 @@ CirReadCmd::exec(const string& option)
    if (options.empty())
       return CmdExec::errorOption(CMD_OPT_MISSING, "");
 
-   bool doReplace = false;
+   bool doReplace = false, doVerbose = false;
    string fileName;
    for (size_t i = 0, n = options.size(); i < n; ++i) {
       if (myStrNCmp("-Replace", options[i], 2) == 0) {
          if (doReplace) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
          doReplace = true;
       }
+      else if (myStrNCmp("-Verbose", options[i], 2) == 0) {
+         if (doVerbose) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
+         doVerbose = true;
+      }
       else {
          if (fileName.size())
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
@@ -93,7 +102,7 @@ CirReadCmd::exec(const string& option)
    }
    cirMgr = new CirMgr;
 
-   if (!cirMgr->readCircuit(fileName)) {
+   if (!cirMgr->readCircuit(fileName, doVerbose)) {
       curCmd = CIRINIT;
       delete cirMgr; cirMgr = 0;
       return CMD_EXEC_ERROR;
@@ -107,14 +116,15 @@ CirReadCmd::exec(const string& option)
 void
 CirReadCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRRead <(string fileName)> [-Replace]" << endl;
+   os << "Usage: CIRRead <(string fileName)> [-Replace] [-Verbose]" << endl;
 }
 
 void
 CirReadCmd::help() const
 {
    cout << setw(15) << left << "CIRRead: "
-        << "read in a circuit and construct the netlist" << endl;
+        << "read in a circuit (aag or aig) and construct the netlist"
+        << endl;
 }
 
 //----------------------------------------------------------------------
@@ -388,52 +398,245 @@ CirSimCmd::exec(const string& option)
    vector<string> options;
    CmdExec::lexOptions(option, options);
 
-   ifstream patternFile;
+   string patternFile, refLog;
    ofstream logFile;
-   bool doRandom = false, doFile = false, doLog = false;
+   bool doRandom = false, doFile = false, doExhaust = false, doLog = false;
+   bool doBinary = false, doDiff = false, doWidth = false, doThreads = false;
+   bool doLevel = false, doIncr = false, doSeed = false;
+   bool doAdapt = false, doMaxPat = false, doTimeout = false;
+   bool doCone = false, doFault = false, doX = false, doStats = false;
+   bool doWeights = false;
+   string statFile, weightFile;
+   vector<unsigned> coneRoots;
+   int width = 0, nThreads = 0, seed = 0;
+   int stallRounds = 8, maxPatterns = 0, timeout = 0;
    for (size_t i = 0, n = options.size(); i < n; ++i) {
       if (myStrNCmp("-Random", options[i], 2) == 0) {
-         if (doRandom || doFile)
+         if (doRandom || doFile || doExhaust)
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
          doRandom = true;
       }
       else if (myStrNCmp("-File", options[i], 2) == 0) {
-         if (doRandom || doFile)
+         if (doRandom || doFile || doExhaust)
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
          if (++i == n)
             return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
-         patternFile.open(options[i].c_str(), ios::in);
-         if (!patternFile)
+         if (!ifstream(options[i].c_str()))
             return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[i]);
+         patternFile = options[i];
          doFile = true;
       }
+      else if (myStrNCmp("-Exhaustive", options[i], 2) == 0) {
+         if (doRandom || doFile || doExhaust)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doExhaust = true;
+      }
       else if (myStrNCmp("-Output", options[i], 2) == 0) {
          if (doLog)
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
          if (++i == n)
             return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
-         logFile.open(options[i].c_str(), ios::out);
+         logFile.open(options[i].c_str(), ios::out | ios::binary);
          if (!logFile)
             return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[i]);
          doLog = true;
       }
+      else if (myStrNCmp("-Width", options[i], 2) == 0) {
+         if (doWidth)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], width) || width < 64 || width % 64 != 0
+             || width > (1 << 20))
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doWidth = true;
+      }
+      else if (myStrNCmp("-Threads", options[i], 2) == 0) {
+         if (doThreads)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], nThreads) || nThreads < 1 ||
+             nThreads > 1024)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doThreads = true;
+      }
+      else if (myStrNCmp("-Levelized", options[i], 2) == 0) {
+         if (doLevel)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doLevel = true;
+      }
+      else if (myStrNCmp("-Seed", options[i], 2) == 0) {
+         if (doSeed)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], seed))
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doSeed = true;
+      }
+      else if (myStrNCmp("-WEights", options[i], 3) == 0) {
+         if (doWeights)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         // optional weight file; none for weights from signal probabilities
+         if (i + 1 < n && options[i+1][0] != '-') {
+            weightFile = options[++i];
+            if (!ifstream(weightFile.c_str()))
+               return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, weightFile);
+         }
+         doWeights = true;
+      }
+      else if (myStrNCmp("-Adaptive", options[i], 2) == 0) {
+         if (doAdapt)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         // optional number of rounds without refinement
+         int k;
+         if (i + 1 < n && myStr2Int(options[i+1], k)) {
+            if (k < 1)
+               return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i+1]);
+            stallRounds = k;
+            ++i;
+         }
+         doAdapt = true;
+      }
+      else if (myStrNCmp("-Patterns", options[i], 2) == 0) {
+         if (doMaxPat)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], maxPatterns) || maxPatterns < 1)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doMaxPat = true;
+      }
+      else if (myStrNCmp("-TImeout", options[i], 3) == 0) {
+         if (doTimeout)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], timeout) || timeout < 1)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doTimeout = true;
+      }
+      else if (myStrNCmp("-Cone", options[i], 2) == 0) {
+         if (doCone)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         // optional gateIds; none for the cone of the FEC candidates
+         int id;
+         while (i + 1 < n && myStr2Int(options[i+1], id)) {
+            if (id < 0 || !cirMgr->getGate(id))
+               return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i+1]);
+            coneRoots.push_back(id);
+            ++i;
+         }
+         doCone = true;
+      }
+      else if (myStrNCmp("-FAult", options[i], 3) == 0) {
+         if (doFault)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doFault = true;
+      }
+      else if (myStrNCmp("-STats", options[i], 3) == 0) {
+         if (doStats)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         // optional output file
+         if (i + 1 < n && options[i+1][0] != '-') {
+            statFile = options[++i];
+            if (!ofstream(statFile.c_str()))
+               return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, statFile);
+         }
+         doStats = true;
+      }
+      else if (myStrNCmp("-Xvalue", options[i], 2) == 0) {
+         if (doX)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doX = true;
+      }
+      else if (myStrNCmp("-Incremental", options[i], 2) == 0) {
+         if (doIncr)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doIncr = true;
+      }
+      else if (myStrNCmp("-Binary", options[i], 2) == 0) {
+         if (doBinary || doDiff)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doBinary = true;
+      }
+      else if (myStrNCmp("-Diff", options[i], 2) == 0) {
+         if (doDiff || doBinary)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!ifstream(options[i].c_str()))
+            return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[i]);
+         refLog = options[i];
+         doDiff = true;
+      }
       else
          return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
    }
 
-   if (!doRandom && !doFile)
+   if (!doRandom && !doFile && !doExhaust)
       return CmdExec::errorOption(CMD_OPT_MISSING, "");
+   if ((doSeed || doAdapt || doWeights) && !doRandom) {
+      cerr << "Error: -Seed, -Adaptive and -WEights require -Random!!"
+           << endl;
+      return CMD_EXEC_ERROR;
+   }
+   if ((doMaxPat || doTimeout) && !doAdapt) {
+      cerr << "Error: -Patterns and -TImeout require -Adaptive!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   if (doCone && (doLog || doFault || doStats)) {
+      cerr << "Error: -Cone cannot be used with -Output, -FAult or -STats!!"
+           << endl;
+      return CMD_EXEC_ERROR;
+   }
+   if (doX && (doLevel || doIncr || doFault || doStats || doBinary)) {
+      cerr << "Error: -Xvalue cannot be used with -Levelized, -Incremental, "
+           << "-FAult, -STats or -Binary!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   if ((doBinary || doDiff) && !doLog) {
+      cerr << "Error: -Binary and -Diff require -Output!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
 
    assert (curCmd != CIRINIT);
+   // the one-command settings must not leak into the next CIRSIMulate,
+   // whichever way this one returns
+   struct SimOptionReset {
+      ~SimOptionReset() { cirMgr->resetSimOptions(); }
+   } simOptionReset;
+   if (doWidth)
+      cirMgr->setSimWidth(width);
+   if (doThreads)
+      cirMgr->setSimThreads(nThreads);
+   cirMgr->setSimLevelized(doLevel);
+   cirMgr->setSimIncremental(doIncr);
+   // without -Seed, a different pattern stream in every run
+   cirMgr->setSimSeed(doSeed? (unsigned)seed:
+                      ((ull)time(0) << 20) ^ (ull)getpid());
+   cirMgr->setSimAdaptive(doAdapt? stallRounds: 0, maxPatterns, timeout);
+   cirMgr->setSimCone(coneRoots, doCone && coneRoots.empty());
+   cirMgr->setSimFault(doFault);
+   cirMgr->setSimX(doX);
+   cirMgr->setSimStats(doStats, statFile);
+   if (!cirMgr->setSimWeights(doWeights, weightFile))
+      return CMD_EXEC_ERROR;
    if (doLog)
-      cirMgr->setSimLog(&logFile);
+      cirMgr->setSimLog(&logFile, doBinary);
    else cirMgr->setSimLog(0);
+   if (!cirMgr->setSimLogRef(refLog))
+      return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, refLog);
 
+   bool ok = true;
    if (doRandom)
       cirMgr->randomSim();
-   else
-      cirMgr->fileSim(patternFile);
-   cirMgr->setSimLog(0);
+   else if (doExhaust)
+      ok = cirMgr->exhaustiveSim();
+   else ok = cirMgr->fileSim(patternFile);
+   if (!ok)
+      return CMD_EXEC_ERROR;
    curCmd = CIRSIMULATE;
    
    return CMD_EXEC_DONE;
@@ -442,8 +645,21 @@ CirSimCmd::exec(const string& option)
 void
 CirSimCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRSIMulate <-Random | -File <string patternFile>>\n"
-      << "                   [-Output (string logFile)]" << endl;
+   os << "Usage: CIRSIMulate <-Random [-Seed (int seed)]"
+      << " [-WEights [(string weightFile)]]\n"
+      << "                    [-Adaptive [(int stallRounds)]\n"
+      << "                     [-Patterns (int maxPatterns)]"
+      << " [-TImeout (int seconds)]] |\n"
+      << "                    -File <string patternFile> | -Exhaustive>\n"
+      << "                   [-Width (int patternsPerRound)]"
+      << " [-Threads (int numThreads)]\n"
+      << "                   [-Levelized] [-Incremental]"
+      << " [-Cone [(int gateId)...]]\n"
+      << "                   [-FAult] [-Xvalue]"
+      << " [-STats [(string statFile)]]\n"
+      << "                   [-Output (string logFile)\n"
+      << "                    [-Binary | -Diff (string refLogFile)]]"
+      << endl;
 }
 
 void
@@ -494,7 +710,7 @@ CirFraigCmd::help() const
 }
 
 //----------------------------------------------------------------------
-//    CIRWrite [(int gateId)][-Output (string aagFile)]
+//    CIRWrite [(int gateId)][-Output (string aagFile)][-Binary]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirWriteCmd::exec(const string& option)
@@ -511,7 +727,8 @@ CirWriteCmd::exec(const string& option)
       cirMgr->writeAag(cout);
       return CMD_EXEC_DONE;
    }
-   bool hasFile = false;
+   bool hasFile = false, doBinary = false;
+   string binaryOpt, fileName;
    int gateId;
    CirGate *thisGate = NULL;
    ofstream outfile;
@@ -521,11 +738,15 @@ CirWriteCmd::exec(const string& option)
             return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
          if (++i == n)
             return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
-         outfile.open(options[i].c_str(), ios::out);
-         if (!outfile)
-            return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[1]);
+         fileName = options[i];
          hasFile = true;
       }
+      else if (myStrNCmp("-Binary", options[i], 2) == 0) {
+         if (doBinary)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         binaryOpt = options[i];
+         doBinary = true;
+      }
       else if (myStr2Int(options[i], gateId) && gateId >= 0) {
          if (thisGate != NULL)
             return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
@@ -542,9 +763,29 @@ CirWriteCmd::exec(const string& option)
       else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
    }
 
+   if (thisGate && doBinary) {
+      cerr << "Error: binary output is only supported for the whole circuit!!"
+           << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // binary AIGER is not for the terminal
+   if (doBinary && !hasFile)
+      return CmdExec::errorOption(CMD_OPT_MISSING, binaryOpt);
+   if (doBinary && cirMgr->dfsFloatNum()) {
+      cerr << "Error: floating fanins cannot be written in binary AIGER!!"
+           << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // opened only now, so that a rejected command leaves the file alone
+   if (hasFile) {
+      outfile.open(fileName.c_str(), ios::out | ios::binary);
+      if (!outfile)
+         return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, fileName);
+   }
    if (!thisGate) {
-      assert (hasFile);
-      cirMgr->writeAag(outfile);
+      ostream& os = hasFile? (ostream&)outfile: cout;
+      if (doBinary) cirMgr->writeAig(os);
+      else cirMgr->writeAag(os);
    }
    else if (hasFile) cirMgr->writeGate(outfile, thisGate);
    else cirMgr->writeGate(cout, thisGate);
@@ -555,13 +796,163 @@ CirWriteCmd::exec(const string& option)
 void
 CirWriteCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRWrite [(int gateId)][-Output (string aagFile)]" << endl;
+   os << "Usage: CIRWrite [(int gateId)][-Output (string aagFile)"
+      << " [-Binary]]" << endl;
 }
 
 void
 CirWriteCmd::help() const
 {
    cout << setw(15) << left << "CIRWrite: "
-        << "write the netlist to an ASCII AIG file (.aag)\n";
+        << "write the netlist to an AIGER file (.aag or .aig)\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRSAve <(string fileName)> [-Signature]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirSaveCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+   if (options.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+
+   bool doSig = false;
+   string fileName;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Signature", options[i], 2) == 0) {
+         if (doSig) return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doSig = true;
+      }
+      else {
+         if (fileName.size())
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         fileName = options[i];
+      }
+   }
+   if (fileName.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+
+   if (!cirMgr->writeCheckpoint(fileName, curCmd, doSig))
+      return CMD_EXEC_ERROR;
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirSaveCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRSAve <(string fileName)> [-Signature]" << endl;
+}
+
+void
+CirSaveCmd::help() const
+{
+   cout << setw(15) << left << "CIRSAve: "
+        << "save the circuit and its FEC groups to a checkpoint\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRLoad <(string fileName)> [-Replace]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirLoadCmd::exec(const string& option)
+{
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+   if (options.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+
+   bool doReplace = false;
+   string fileName;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Replace", options[i], 2) == 0) {
+         if (doReplace) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
+         doReplace = true;
+      }
+      else {
+         if (fileName.size())
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         fileName = options[i];
+      }
+   }
+   if (fileName.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+
+   if (cirMgr != 0) {
+      if (doReplace) {
+         cerr << "Note: original circuit is replaced..." << endl;
+         curCmd = CIRINIT;
+         delete cirMgr; cirMgr = 0;
+      }
+      else {
+         cerr << "Error: circuit already exists!!" << endl;
+         return CMD_EXEC_ERROR;
+      }
+   }
+   cirMgr = new CirMgr;
+
+   int state;
+   if (!cirMgr->readCheckpoint(fileName, state)) {
+      curCmd = CIRINIT;
+      delete cirMgr; cirMgr = 0;
+      return CMD_EXEC_ERROR;
+   }
+   curCmd = (state > CIRINIT && state < CIRCMDTOT)?
+            (CirCmdState)state: CIRREAD;
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirLoadCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRLoad <(string fileName)> [-Replace]" << endl;
 }
 
+void
+CirLoadCmd::help() const
+{
+   cout << setw(15) << left << "CIRLoad: "
+        << "restore the circuit from a checkpoint\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRPAck <(string asciiPatternFile)> <(string packedPatternFile)>
+//----------------------------------------------------------------------
+CmdExecStatus
+CirPackCmd::exec(const string& option)
+{
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options, 2))
+      return CMD_EXEC_ERROR;
+
+   if (!CirMgr::packPatterns(options[0], options[1]))
+      return CMD_EXEC_ERROR;
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirPackCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRPAck <(string asciiPatternFile)> "
+      << "<(string packedPatternFile)>" << endl;
+}
+
+void
+CirPackCmd::help() const
+{
+   cout << setw(15) << left << "CIRPAck: "
+        << "convert a pattern file into the packed binary format\n";
+}
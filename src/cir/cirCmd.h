@@ -20,5 +20,8 @@ CmdClass(CirStrashCmd);
 CmdClass(CirSimCmd);
 CmdClass(CirFraigCmd);
 CmdClass(CirWriteCmd);
+CmdClass(CirSaveCmd);
+CmdClass(CirLoadCmd);
+CmdClass(CirPackCmd);
 
 #endif // CIR_CMD_H
@@ -0,0 +1,219 @@
+/****************************************************************************
+  FileName     [ cirFault.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define stuck-at fault simulation ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include "cirMgr.h"
+#include "cirGate.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+// Parallel-pattern single-fault propagation (PPSFP): after the good
+// circuit is simulated on a batch of patterns (CIRSIMulate -FAult), each
+// undetected fault is injected alone and propagated over all the
+// patterns at once. Only the gates in the fanout cone of the fault site
+// whose values actually change are re-evaluated, level by level; the
+// fault is detected as soon as a changed value reaches a PO, and is then
+// dropped from the list.
+//
+//    _faultList      collapsed faults as literals (gateId*2 + stuck-at
+//                    value) not yet detected
+//    _faultWork      per-thread state of faultDetect() (see FaultWork)
+//
+// Faults are on the outputs of PIs, AIGs in netList and POs. They are
+// collapsed by equivalence: if gate g has a single fanout h, then
+// g stuck-at-inv (inv: the edge inversion) is equivalent to h stuck-at-0
+// if h is an AIG, and both faults of g are equivalent to the faults of h
+// if h is a PO; only the faults of h are kept.
+
+/*****************************************************/
+/*   Private member functions about fault simulation  */
+/*****************************************************/
+// Build the collapsed fault list
+void
+CirMgr::faultBegin()
+{
+   _faultList.clear();
+   _faultTotal = 0;
+   _faultDetected = 0;
+   _faultEvals = 0;
+   _faultSecs = 0;
+   // fanouts in netList only
+   vector<unsigned> fo(_aigType.size(), 0), foLit(_aigType.size(), 0);
+   auto addFanouts = [&](unsigned gid) {
+      unsigned la = _aigFanin[2 * gid];
+      ++fo[la >> 1];
+      foLit[la >> 1] = 2 * gid + (la & 1);
+      if (_aigType[gid] == AIG_GATE) {
+         unsigned lb = _aigFanin[2 * gid + 1];
+         ++fo[lb >> 1];
+         foLit[lb >> 1] = 2 * gid + (lb & 1);
+      }
+   };
+   for (unsigned gid : _aigOrder)
+      addFanouts(gid);
+   for (int gid = MILOA[0] + 1; gid <= MILOA[0] + MILOA[3]; ++gid)
+      addFanouts(gid);
+
+   auto addFaults = [&](unsigned gid) {
+      _faultTotal += 2;
+      if (fo[gid] != 1) {
+         _faultList.push_back(2 * gid);
+         _faultList.push_back(2 * gid + 1);
+      }
+      else if (_aigType[foLit[gid] >> 1] == AIG_GATE)
+         _faultList.push_back(2 * gid + !(foLit[gid] & 1));
+   };
+   for (int i = 1; i <= MILOA[1]; ++i)
+      addFaults(CirCuit[i]->gateId);
+   for (unsigned gid : _aigOrder)
+      addFaults(gid);
+   for (int gid = MILOA[0] + 1; gid <= MILOA[0] + MILOA[3]; ++gid)
+      addFaults(gid);
+   _faultCollapsed = _faultList.size();
+
+   _faultWork.resize(_simPool.size());
+   for (FaultWork& w : _faultWork) {
+      w.stamp.assign(_aigType.size(), 0);
+      w.queued.assign(_aigType.size(), 0);
+      w.slot.resize(_aigType.size());
+      w.queue.resize(_aigLevelOffset.size() + 1);
+      w.epoch = 0;
+   }
+}
+
+// Return true if fault "f" is detected by the first "nw" words of the
+// current batch; "last" masks the valid patterns of the last word
+bool
+CirMgr::faultDetect(FaultWork& w, unsigned f, size_t nw, ull last) const
+{
+   const unsigned site = f >> 1;
+   const ull stuck = -(ull)(f & 1);
+   const ull* good = simValue(site);
+   if (_aigType[site] == PO_GATE) {
+      for (size_t k = 0; k < nw; ++k)
+         if ((good[k] ^ stuck) & (k + 1 < nw? ~0ULL: last)) return true;
+      return false;
+   }
+
+   if (++w.epoch == 0) {
+      fill(w.stamp.begin(), w.stamp.end(), 0);
+      fill(w.queued.begin(), w.queued.end(), 0);
+      w.epoch = 1;
+   }
+   size_t used = 0;
+   auto alloc = [&](unsigned gid) {
+      w.stamp[gid] = w.epoch;
+      w.slot[gid] = used++;
+      if (w.val.size() < used * nw) w.val.resize(2 * used * nw);
+      return &w.val[w.slot[gid] * nw];
+   };
+   auto value = [&](unsigned gid) {
+      return w.stamp[gid] == w.epoch? &w.val[w.slot[gid] * nw]:
+                                      simValue(gid);
+   };
+
+   // excite
+   ull* v = alloc(site);
+   bool excited = false;
+   for (size_t k = 0; k < nw; ++k) {
+      v[k] = good[k] ^ ((good[k] ^ stuck) & (k + 1 < nw? ~0ULL: last));
+      excited |= v[k] != good[k];
+   }
+   if (!excited) return false;
+
+   // propagate; a PO fanout of a changed gate detects the fault
+   size_t lo = w.queue.size(), hi = 0;
+   auto schedule = [&](unsigned gid) {
+      for (unsigned j = _aigFoOffset[gid]; j < _aigFoOffset[gid + 1]; ++j) {
+         unsigned fo = _aigFanout[j] >> 1;
+         if (_aigType[fo] == PO_GATE) return true;
+         unsigned l = _aigLevel[fo];
+         if (!l || w.queued[fo] == w.epoch) continue;
+         w.queued[fo] = w.epoch;
+         w.queue[l].push_back(fo);
+         if (l < lo) lo = l;
+         if (l > hi) hi = l;
+      }
+      return false;
+   };
+   bool detected = schedule(site);
+   vector<ull>& tmp = w.tmp;
+   tmp.resize(nw);
+   for (size_t l = lo; l <= hi && !detected; ++l) {
+      vector<unsigned>& q = w.queue[l];
+      for (size_t i = 0; i < q.size() && !detected; ++i) {
+         unsigned gid = q[i];
+         unsigned la = _aigFanin[2 * gid], lb = _aigFanin[2 * gid + 1];
+         const ull *a = value(la >> 1), *b = value(lb >> 1);
+         const ull ma = -(ull)(la & 1), mb = -(ull)(lb & 1);
+         const ull* g = simValue(gid);
+         bool changed = false;
+         for (size_t k = 0; k < nw; ++k) {
+            tmp[k] = (a[k] ^ ma) & (b[k] ^ mb);
+            changed |= tmp[k] != g[k];
+         }
+         if (!changed) continue;
+         memcpy(alloc(gid), tmp.data(), nw * sizeof(ull));
+         detected = schedule(gid);
+      }
+   }
+   for (size_t l = lo; l <= hi; ++l)
+      w.queue[l].clear();
+   return detected;
+}
+
+// Simulate the undetected faults on the first n patterns of the current
+// batch, split across the simulation threads, and drop the detected ones
+void
+CirMgr::faultSimulate(int n)
+{
+   if (n <= 0 || _faultList.empty()) return;
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   const size_t nw = (n + 63) / 64, nFault = _faultList.size();
+   const ull last = n % 64? (1ULL << (n % 64)) - 1: ~0ULL;
+   vector<unsigned char> hit(nFault, 0);
+   atomic<size_t> next(0);
+   _simPool.run([&](size_t t) {
+      FaultWork& w = _faultWork[t];
+      for (size_t i0; (i0 = next.fetch_add(64)) < nFault; )
+         for (size_t i = i0; i < i0 + 64 && i < nFault; ++i)
+            hit[i] = faultDetect(w, _faultList[i], nw, last);
+   });
+
+   size_t m = 0;
+   for (size_t i = 0; i < nFault; ++i)
+      if (!hit[i]) _faultList[m++] = _faultList[i];
+   _faultList.resize(m);
+   _faultDetected += nFault - m;
+   _faultEvals += nFault;
+   _faultSecs += chrono::duration<double>(chrono::steady_clock::now()
+                                          - start).count();
+}
+
+void
+CirMgr::faultReport() const
+{
+   cout << "Faults: " << _faultTotal << " stuck-at, " << _faultCollapsed
+        << " collapsed, " << _faultDetected << " detected ("
+        << fixed << setprecision(2)
+        << (_faultCollapsed? 100.0 * _faultDetected / _faultCollapsed: 0)
+        << "% coverage)." << endl;
+   cout << "Fault simulation: " << _faultEvals << " fault batches in "
+        << setprecision(3) << _faultSecs << " s ("
+        << setprecision(0) << (_faultSecs > 0? _faultEvals / _faultSecs: 0)
+        << " faults/sec)." << endl;
+   cout.unsetf(ios::floatfield);
+   cout << setprecision(6);
+}
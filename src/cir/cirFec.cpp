@@ -0,0 +1,222 @@
+/****************************************************************************
+  FileName     [ cirFec.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the FEC partition refinement engine ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <cstring>
+#include "cirMgr.h"
+#include "cirGate.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+// While simulating, the FEC candidates are kept as a partition of gates
+// into classes; fecGroup is only generated from it at the end of a
+// simulation command (fecExport()).
+//
+//    _fecLit[first .. first+size-1], (first, size) = _fecClass[c]
+//                      members of class c as literals (gateId*2 + phase)
+//
+// A member's value XOR-ed with its phase (all 0s or all 1s) is the same
+// for all the members of a class, so a gate and its complement share a
+// class and each member is hashed and looked up once per round.
+// Every round splits each class by a 64-bit hash of the new values of
+// its members; a member is compared in full only against the first
+// member with the same hash, so that a hash collision opens a new
+// subclass. The subclasses are reordered in place within the class's
+// range of _fecLit; the scratch arrays are sized once in fecInit().
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+static inline ull
+fecHash(const ull* v, ull m, size_t n)
+{
+   ull h = 0;
+   for (size_t k = 0; k < n; ++k)
+      h = (h ^ v[k] ^ m) * 0x9E3779B97F4A7C15ULL;
+   return h ^ (h >> 32);
+}
+
+// true if a ^ b is m in every word
+static inline bool
+fecEqual(const ull* a, const ull* b, ull m, size_t n)
+{
+   for (size_t k = 0; k < n; ++k)
+      if ((a[k] ^ b[k]) != m) return false;
+   return true;
+}
+
+/**********************************************/
+/*   Private member functions about FEC       */
+/**********************************************/
+// Start a simulation command from the current fecGroup (which keeps the
+// phases). If there is none, all AIGs in netList and CONST 0 form a
+// single class, whose phases are taken from the first pattern of the
+// first round, i.e. every member is taken in its bit-0-false phase.
+// Gates that are gone from the circuit are dropped. If the simulation
+// is restricted to the cone of some gates (see buildSimCone()), only the
+// gates in the cone are candidates, and the groups with members outside
+// of it are set aside in _fecFrozen and exported as they are.
+void
+CirMgr::fecInit()
+{
+   const bool cone = _simConeOn && !_simConeFec;
+   _fecLit.clear();
+   _fecClass.clear();
+   _fecFrozen.clear();
+   _fecFresh = fecGroup.empty();
+   if (_fecFresh) {
+      _fecLit.push_back(0);
+      for (unsigned gid : _aigOrder)
+         if (!cone || _simConeMark[gid])
+            _fecLit.push_back(2 * gid);
+   }
+   else for (const vector<unsigned>& grp : fecGroup) {
+      size_t first = _fecLit.size();
+      bool frozen = false;
+      for (unsigned lit : grp) {
+         unsigned gid = lit >> 1;
+         if (gid >= _aigType.size() ||
+             (_aigType[gid] != AIG_GATE && _aigType[gid] != CONST_GATE))
+            continue;
+         _fecLit.push_back(lit);
+         frozen |= cone && !_simConeMark[gid];
+      }
+      if (frozen && _fecLit.size() - first > 1) {
+         _fecFrozen.push_back(vector<unsigned>(_fecLit.begin() + first,
+                                               _fecLit.end()));
+         _fecLit.resize(first);
+      }
+      else if (_fecLit.size() - first > 1)
+         _fecClass.push_back(FecClass(first, _fecLit.size() - first));
+      else _fecLit.resize(first);
+   }
+   if (_fecFresh && _fecLit.size() > 1)
+      _fecClass.push_back(FecClass(0, _fecLit.size()));
+
+   size_t n = _fecLit.size();
+   _fecSub.resize(n);
+   _fecTmp.resize(n);
+   _fecSubRep.resize(n);
+   _fecSubCnt.resize(n);
+   _fecSubHash.resize(n);
+   size_t t = 4;
+   while (t < 2 * n) t <<= 1;
+   _fecTable.resize(t);
+
+   _fecPairs = 0;
+   for (const FecClass& c : _fecClass)
+      _fecPairs += (size_t)c.second * (c.second - 1) / 2;
+}
+
+// Split the classes by the current simulation values
+void
+CirMgr::fecRefine()
+{
+   const size_t W = _simWords;
+   if (_fecFresh) {
+      for (unsigned& lit : _fecLit)
+         lit = (lit & ~1u) | (simValue(lit >> 1)[0] & 1);
+      _fecFresh = false;
+   }
+
+   _fecNext.clear();
+   _fecPairs = 0;
+   for (const FecClass& c : _fecClass) {
+      unsigned* mem = &_fecLit[c.first];
+      const size_t n = c.second;
+      size_t mask = 3;
+      while (mask + 1 < 2 * n) mask = 2 * mask + 1;
+      fill(_fecTable.begin(), _fecTable.begin() + mask + 1, ~0u);
+
+      // subclass of each member
+      unsigned numSub = 0;
+      for (size_t i = 0; i < n; ++i) {
+         const ull* v = simValue(mem[i] >> 1);
+         ull m = -(ull)(mem[i] & 1);
+         ull h = fecHash(v, m, W);
+         size_t s = h & mask;
+         unsigned j;
+         while ((j = _fecTable[s]) != ~0u) {
+            unsigned rep = mem[_fecSubRep[j]];
+            if (_fecSubHash[j] == h &&
+                fecEqual(v, simValue(rep >> 1), m ^ -(ull)(rep & 1), W))
+               break;
+            s = (s + 1) & mask;
+         }
+         if (j == ~0u) {
+            j = _fecTable[s] = numSub++;
+            _fecSubRep[j] = i;
+            _fecSubHash[j] = h;
+            _fecSubCnt[j] = 0;
+         }
+         _fecSub[i] = j;
+         ++_fecSubCnt[j];
+      }
+      if (numSub == 1) {
+         _fecNext.push_back(c);
+         _fecPairs += n * (n - 1) / 2;
+         continue;
+      }
+
+      // counting sort of the members by subclass; keep subclasses of 2+
+      unsigned start = 0;
+      for (unsigned j = 0; j < numSub; ++j) {
+         unsigned cnt = _fecSubCnt[j];
+         _fecSubCnt[j] = start;
+         if (cnt > 1) {
+            _fecNext.push_back(FecClass(c.first + start, cnt));
+            _fecPairs += (size_t)cnt * (cnt - 1) / 2;
+         }
+         start += cnt;
+      }
+      for (size_t i = 0; i < n; ++i)
+         _fecTmp[_fecSubCnt[_fecSub[i]]++] = mem[i];
+      memcpy(mem, _fecTmp.data(), n * sizeof(unsigned));
+   }
+   _fecClass.swap(_fecNext);
+}
+
+// Drop the members marked in "gone" (by gateId), and the classes left
+// with fewer than 2 members
+void
+CirMgr::fecRemove(const vector<bool>& gone)
+{
+   _fecNext.clear();
+   _fecPairs = 0;
+   for (const FecClass& c : _fecClass) {
+      unsigned* mem = &_fecLit[c.first];
+      unsigned n = 0;
+      for (unsigned i = 0; i < c.second; ++i)
+         if (!gone[mem[i] >> 1]) mem[n++] = mem[i];
+      if (n < 2) continue;
+      _fecNext.push_back(FecClass(c.first, n));
+      _fecPairs += (size_t)n * (n - 1) / 2;
+   }
+   _fecClass.swap(_fecNext);
+}
+
+// Regenerate fecGroup (and the gates' fecIdx) from the classes; "exact"
+// if every input pattern has been simulated
+void
+CirMgr::fecExport(bool exact)
+{
+   _fecExact = exact && _fecFrozen.empty();
+   fecGroup.resize(_fecClass.size());
+   for (size_t i = 0, n = _fecClass.size(); i < n; ++i) {
+      const unsigned* mem = &_fecLit[_fecClass[i].first];
+      fecGroup[i].assign(mem, mem + _fecClass[i].second);
+   }
+   fecGroup.insert(fecGroup.end(), _fecFrozen.begin(), _fecFrozen.end());
+   for (CirGate* g : CirCuit)
+      g->fecIdx = -1;
+   fecGroupSort_ReId();
+   setFecIdx();
+}
@@ -14,7 +14,6 @@
 #include "myHashMap.h"
 #include "util.h"
 #define hkey unsigned long long int
-#define pii pair<int, int>
 using namespace std;
 
 // TODO: Please keep "CirMgr::strash()" and "CirMgr::fraig()" for cir cmd.
@@ -48,24 +47,28 @@ void
 CirMgr::strash()
 {
   memset(delCirIdHash, 0, (MILOA[0] + MILOA[3] + 1) * sizeof(bool));
-  unordered_map<hkey, CirGate*> strHash;
+  syncAig();
+  unordered_map<hkey, unsigned> strHash;
+  strHash.reserve(_aigOrder.size());
+  // repr[gid]: literal that gate gid has been merged into
+  vector<unsigned> repr(_aigType.size());
+  for (size_t i = 0; i < repr.size(); ++i)
+    repr[i] = 2 * i;
 
   // check through netlist
-  for (CirGate* curGate : netList) {
-    if (curGate->gateType != AIG_GATE) continue;
-    hkey k = hkeyGen(
-      (unsigned int)curGate->fanIn[0]->gateId, (unsigned int)curGate->fanIn[1]->gateId,
-      curGate->fanIn_inv[0], curGate->fanIn_inv[1]);
-    CirGate* mergeGate;
-    if (strHash.find(k) != strHash.end()) {
-      mergeGate = strHash[k];
-      mergeGate->merge(curGate, false);
+  for (unsigned gid : _aigOrder) {
+    unsigned la = _aigFanin[2 * gid], lb = _aigFanin[2 * gid + 1];
+    la = repr[la >> 1] ^ (la & 1);
+    lb = repr[lb >> 1] ^ (lb & 1);
+    hkey k = hkeyGen(la >> 1, lb >> 1, la & 1, lb & 1);
+    pair<unordered_map<hkey, unsigned>::iterator, bool> ins =
+      strHash.insert(make_pair(k, gid));
+    if (!ins.second) {
+      unsigned mergeId = ins.first->second;
+      Map[mergeId]->merge(Map[gid], false);
+      repr[gid] = 2 * mergeId;
       --MILOA[4];
-      delCirIdHash[curGate->gateId] = true;
-      // cout << "Simplifying: " << mergeGate->gateId <<" merging " << curGate->gateId<<"..." << endl;
-    }
-    else {
-      strHash[k] = curGate;
+      delCirIdHash[gid] = true;
     }
   }
   // handle netlist
@@ -81,90 +84,143 @@ CirMgr::strash()
   gen_with_float();
 }
 
+// Prove the FEC candidates with SAT. Every member of a class is checked
+// against the class representative, its earliest member in topological
+// order (so that merging never creates a cycle), with a fresh XOR
+// variable per check. A satisfying assignment is a counterexample: its
+// PI values and 63 distance-1 neighbours (one PI flipped each) are packed
+// into one simulation word, and once _simWords of them are collected,
+// all the remaining classes are resimulated and refined, which splits
+// off every member disproved so far and usually many others with it.
+// The proven gates are merged into their representatives at the end.
+// FEC groups from exhaustive simulation are merged without SAT calls.
 void
 CirMgr::fraig()
 {
+  if (fecGroup.empty()) return;
   SatSolver solver;
   solver.initialize();
-  int fecSize = fecGroup.size();
-  bool visited[fecSize] {false};
-
-  vector<int> delGateVec;
-  vector<pii> delPairs;
-
-  CirCuit[0]->satVar = solver.newVar();
-  solver.assertProperty(CirCuit[0]->satVar, false);
-
-  for (CirGate* cur : netList) {
-    if (cur->gateType == PO_GATE) {
-      continue;
-    } else if (cur->gateType == PI_GATE) {
-      cur->satVar = solver.newVar();
-    } else if (cur->isAig()) {
-      solver.addAigCNF(cur->satVar, cur->fanIn[0]->satVar, cur->fanIn_inv[0],
-          cur->fanIn[1]->satVar, cur->fanIn_inv[1]);
-    }
-  }
 
-  for (CirGate* cur : netList) {
-    if (!cur->isAig()) continue;
-    int fId = cur->fecIdx;
-    if (fId == -1) continue;
-    if (visited[fId]) continue;
-    visited[fId] = true;
-
-    delPairs.clear();
-    Var fV = solver.newVar();
-    int gSize = fecGroup[cur->fecIdx].size();
-    bool deleted[gSize] {false};
-
-    for (int i = 0; i < gSize - 1; ++i) {
-      if (deleted[i]) continue;
-      for (int j = i+1; j < gSize; ++j) {
-        CirGate* aPtr = Map[fecGroup[fId][i]];
-        CirGate* bPtr = Map[fecGroup[fId][j]];
-        bool invAB = true;
-        if (aPtr->gateValue != bPtr->gateValue)
-          invAB = false;
-
-        solver.addXorCNF(fV, aPtr->satVar, true, bPtr->satVar, invAB);
-        solver.assumeProperty(fV, true);
-        if ((!solver.assumpSolve())) {
-          delPairs.push_back(pii(i, j));
-          deleted[j] = true;
-        }
-        solver.assumeRelease();
+  // gateId -> SAT variable, created on demand for the fanin cones of the
+  // gates compared, so that the solver only holds the logic that matters
+  // (a satisfying assignment covers every variable); floating fanins
+  // (UNDEF gates) are constant 0, as in simulation
+  syncAig();
+  initSimArena();
+  const Var noVar = -1;
+  vector<Var> satVar(_aigType.size(), noVar);
+  Var constVar = solver.newVar();
+  solver.assertProperty(constVar, false);
+  vector<unsigned> stack;
+  auto coneVar = [&](unsigned root) {
+    stack.push_back(root);
+    while (!stack.empty()) {
+      unsigned gid = stack.back();
+      if (satVar[gid] != noVar) { stack.pop_back(); continue; }
+      if (_aigType[gid] != AIG_GATE) {
+        satVar[gid] = _aigType[gid] == PI_GATE? solver.newVar(): constVar;
+        stack.pop_back();
+        continue;
       }
+      unsigned la = _aigFanin[2 * gid], lb = _aigFanin[2 * gid + 1];
+      if (satVar[la >> 1] == noVar) { stack.push_back(la >> 1); continue; }
+      if (satVar[lb >> 1] == noVar) { stack.push_back(lb >> 1); continue; }
+      satVar[gid] = solver.newVar();
+      solver.addAigCNF(satVar[gid], satVar[la >> 1], la & 1,
+                       satVar[lb >> 1], lb & 1);
+      stack.pop_back();
     }
-
-    for (int i = 0; i < delPairs.size(); ++i) {
-      bool invG = false;
-      int a = fecGroup[fId][ delPairs[i].first ];
-      int b = fecGroup[fId][ delPairs[i].second ];
-      if (Map[a] ->gateValue != Map[b] -> gateValue)
-        invG = true;
-      Map[a] -> merge (Map[b], invG);
-      // cout << a << "merging" << b << endl;
-      delGateVec.push_back(b);
+    return satVar[root];
+  };
+  // topological position; CONST 0 comes first
+  vector<unsigned> pos(_aigType.size(), 0);
+  for (size_t i = 0; i < _aigOrder.size(); ++i)
+    pos[_aigOrder[i]] = i + 1;
+
+  const int nPI = MILOA[1];
+  const size_t W = _simWords;
+  vector<ull> cexWords((size_t)nPI * W, 0ULL);
+  size_t nCex = 0, nCall = 0, nSat = 0, nResim = 0, mutBase = 0;
+  RandomWordGen rng(_simSeed);
+  vector<bool> merged(_aigType.size(), false);
+  vector<pair<unsigned, unsigned> > merges;  // (rep gateId, literal)
+
+  fecInit();
+  while (true) {
+    fecRemove(merged);
+    if (_fecClass.empty()) break;
+    for (size_t c = 0; c < _fecClass.size() && nCex < W; ++c) {
+      const unsigned* mem = &_fecLit[_fecClass[c].first];
+      const unsigned n = _fecClass[c].second;
+      unsigned r = 0;
+      for (unsigned i = 1; i < n; ++i)
+        if (pos[mem[i] >> 1] < pos[mem[r] >> 1]) r = i;
+      const unsigned rep = mem[r];
+      for (unsigned i = 0; i < n && nCex < W; ++i) {
+        unsigned lit = mem[i];
+        if (i == r || merged[lit >> 1]) continue;
+        bool inv = (lit ^ rep) & 1;
+        bool proven = _fecExact;
+        if (!proven) {
+          Var f = solver.newVar();
+          solver.addXorCNF(f, coneVar(rep >> 1), false,
+                           coneVar(lit >> 1), inv);
+          solver.assumeRelease();
+          solver.assumeProperty(f, true);
+          proven = !solver.assumpSolve();
+          ++nCall;
+        }
+        if (proven) {
+          merged[lit >> 1] = true;
+          merges.push_back(make_pair(rep >> 1, (lit >> 1) * 2 + inv));
+          continue;
+        }
+        ++nSat;
+        // PIs outside the cones are random
+        for (int j = 0; j < nPI; ++j) {
+          Var v = satVar[CirCuit[j + 1]->gateId];
+          bool b = v == noVar? rng(nSat * nPI + j) & 1:
+                               solver.getValue(v) == 1;
+          cexWords[j * W + nCex] = b? ~0ULL: 0;
+        }
+        for (unsigned b = 1; b < 64 && nPI; ++b)
+          cexWords[((mutBase + b) % nPI) * W + nCex] ^= 1ULL << b;
+        mutBase += 63;
+        ++nCex;
+      }
     }
+    if (nCex == 0) continue;  // all proven; the classes are dropped
+
+    // resimulate the counterexamples (the unused words are all 0)
+    for (int j = 0; j < nPI; ++j)
+      memcpy(simValue(CirCuit[j + 1]->gateId), &cexWords[j * W],
+             W * sizeof(ull));
+    simulateAll();
+    _simPiPrev.clear();  // no baseline for -Incremental
+    fecRemove(merged);
+    fecRefine();
+    fill(cexWords.begin(), cexWords.end(), 0ULL);
+    nCex = 0;
+    ++nResim;
   }
+  solver.assumeRelease();
 
-
-  // handle cirMgr
-
-  delete[] delCirIdHash;
-  int CSize = CirCuit.size();
-  delCirIdHash = new bool[CSize] {false};
-  int delSize = delGateVec.size();
-  MILOA[4] -= delSize;
-  
-  for (int i = 0; i < CSize; ++i) {
-    for (int j = 0; j < delSize; ++j) {
-      if (CirCuit[i]->gateId == delGateVec[j]) {
-        delCirIdHash[delGateVec[j]] = true;
-      }
-    }
+  // merge and delete the proven gates
+  memset(delCirIdHash, 0, (MILOA[0] + MILOA[3] + 1) * sizeof(bool));
+  for (const pair<unsigned, unsigned>& m : merges) {
+    Map[m.first]->merge(Map[m.second >> 1], m.second & 1);
+    delCirIdHash[m.second >> 1] = true;
   }
+  MILOA[4] -= merges.size();
+  cout << "Fraig: " << merges.size() << " gates merged; "
+       << nCall << " SAT calls, " << nSat
+       << " counterexamples, " << nResim << " resimulations." << endl;
+
+  // the FEC groups are resolved
+  fecGroup.clear();
+  _fecExact = false;
+  for (CirGate* g : CirCuit)
+    g->fecIdx = -1;
 
   // handle netlist
   unordered_set<CirGate *> visted;
@@ -173,11 +229,10 @@ CirMgr::fraig()
     genNetList(Map[MILOA[0] + i], visted);
 
   // deleting Gates
-  delHelper();;
-  
+  delHelper();
+
   // handle with_float
   gen_with_float();
-  
 }
 
 /********************************************/
@@ -30,13 +30,14 @@ extern CirMgr *cirMgr;
 /**************************************/
 
 void
-CirGate::delFout_Fin(CirGate* newgate) {
+CirGate::delFout_Fin(CirGate* newgate, bool inv) {
     int foSize = fanOut.size();
     for (int i = 0; i < foSize; ++i) {
       int foFiSize = fanOut[i]->fanIn.size();
       for (int j = 0; j < foFiSize; ++j) {
         if (fanOut[i]->fanIn[j] == this) {
           fanOut[i]->fanIn[j] = newgate;
+          fanOut[i]->fanIn_inv[j] = fanOut[i]->fanIn_inv[j] != inv;
           break;
         }
       }
@@ -61,15 +62,12 @@ void
 CirGate::merge(CirGate* gate, bool invG)
 {
    gate->delFi_Fout();
-   gate->delFout_Fin(this);
+   gate->delFout_Fin(this, invG);
    int size = gate->fanOut.size();
 
    for (int i =  0; i < size; ++i) {
       fanOut.push_back(gate->fanOut[i]);
-      if (invG)
-         fanOut_inv.push_back(~gate->fanOut_inv[i]);
-      else
-         fanOut_inv.push_back(gate->fanOut_inv[i]);
+      fanOut_inv.push_back(gate->fanOut_inv[i] != invG);
    }
 }
 
@@ -83,21 +81,23 @@ CirGate::reportGate() const
    cout << ", line " << line << endl;
    cout << "= FECs:";
    if (fecIdx != -1) {
-      int size = cirMgr->fecGroup[fecIdx].size();
-      for (int i = 0; i < size; ++i) {
-         int curId = cirMgr->fecGroup[fecIdx][i];
-         if (curId == gateId) continue;
+      const vector<unsigned>& grp = cirMgr->fecGroup[fecIdx];
+      unsigned phase = 0;
+      for (unsigned lit : grp)
+         if ((int)(lit >> 1) == gateId) phase = lit & 1;
+      for (unsigned lit : grp) {
+         if ((int)(lit >> 1) == gateId) continue;
          cout << " " ;
-         if (cirMgr->Map[curId]->gateValue != gateValue) cout << '!';
-         cout << curId;
+         if ((lit & 1) != phase) cout << '!';
+         cout << (lit >> 1);
       }
    }
    cout << endl;
    cout << "= Value : ";
-   string tmp = gateValue.to_string().substr(PatternSIZE - 64, 64);
-   for (int i = 63; i > -1; --i) {
-      cout << tmp[i];
-      if (i % 8 == 0 && i > 5) cout << '_';
+   ull v = cirMgr->_simArena? cirMgr->simValue(gateId)[0]: 0;
+   for (int i = 0; i < 64; ++i) {
+      cout << ((v >> i) & 1);
+      if (i % 8 == 7 && i < 63) cout << '_';
    }
    cout << endl;
    cout << "================================================================================" << endl;
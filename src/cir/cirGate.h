@@ -12,11 +12,9 @@
 #include <string>
 #include <vector>
 #include <iostream>
-#include <bitset>
 #include "cirDef.h"
 #include "sat.h"
-#define PatternSIZE 2048 // 32768
-#define e10 1000000000
+#define PatternSIZE 2048 // default simulation width
 #define ull unsigned long long int
 using namespace std;
 
@@ -33,7 +31,7 @@ public:
   CirGate(){}
   CirGate(GateType t, int id, int l, int c):
         gateType(t), gateId(id), line(l), column(c) {
-        gateValue.reset(); fecIdx = -1;}
+        fecIdx = -1;}
   ~CirGate() {}
   
   // Basic access methods
@@ -54,7 +52,7 @@ public:
         return "errow!! in CirGate::getTypeStr() ";
     }
   }
-  unsigned getLineNo() const { return 0; }
+  unsigned getLineNo() const { return line; }
   bool isAig() const { if (gateType == AIG_GATE) return true; return false; }
 
   // Printing functions
@@ -73,8 +71,6 @@ private:
   int gateId;
   int line, column;
   int fecIdx;
-  bitset<PatternSIZE> gateValue;
-  Var satVar;
 
   vector<CirGate *> fanIn;
   vector<bool> fanIn_inv;
@@ -88,7 +84,7 @@ private:
   // helper functions by TT
   void merge(CirGate*, bool);
   void delFi_Fout();
-  void delFout_Fin(CirGate*);
+  void delFout_Fin(CirGate*, bool inv = false);
 
 protected:
 };
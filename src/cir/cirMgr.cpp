@@ -14,9 +14,12 @@
 #include <cstring>
 #include <algorithm>
 #include <stack>
+#include <chrono>
+#include <climits>
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "util.h"
+#include "myMmap.h"
 
 using namespace std;
 
@@ -147,48 +150,166 @@ parseError(CirParseError err)
    return false;
 }
 
+// Cursor on the memory-mapped design file.
+// Tokens are scanned directly from the mapped bytes; lineNo/colNo are
+// kept in sync so that parseError() can point at the offending char.
+static const char *bufPtr  = 0;
+static const char *bufEnd  = 0;
+static const char *lineBeg = 0;
+static bool binaryAig = false;  // "aig" header: binary AND section
+
+static inline void
+setColNo(const char *p)
+{
+   colNo = p - lineBeg;
+}
+
+static bool
+tokenError(const string& what)
+{
+   setColNo(bufPtr);
+   if (bufPtr == bufEnd || *bufPtr == '\n') {
+      errMsg = what;
+      return parseError(MISSING_NUM);
+   }
+   if (*bufPtr == ' ')
+      return parseError(EXTRA_SPACE);
+   if (isspace((unsigned char)*bufPtr)) {
+      errInt = *bufPtr;
+      return parseError(ILLEGAL_WSPACE);
+   }
+   const char *p = bufPtr;
+   while (p != bufEnd && !isspace((unsigned char)*p)) ++p;
+   errMsg = what + "(" + string(bufPtr, p) + ")";
+   return parseError(ILLEGAL_NUM);
+}
+
+static bool
+readNum(int& num, const string& what)
+{
+   const char *p = bufPtr;
+   long long n = 0;
+   while (p != bufEnd && (unsigned)(*p - '0') < 10) {
+      n = n * 10 + (*p++ - '0');
+      if (n > INT_MAX) return tokenError(what);
+   }
+   if (p == bufPtr || (p != bufEnd && !isspace((unsigned char)*p)))
+      return tokenError(what);
+   num = (int)n;
+   bufPtr = p;
+   return true;
+}
+
+static bool
+readSpace()
+{
+   setColNo(bufPtr);
+   if (bufPtr != bufEnd && *bufPtr == ' ') { ++bufPtr; return true; }
+   if (bufPtr != bufEnd && *bufPtr != '\n' &&
+       isspace((unsigned char)*bufPtr)) {
+      errInt = *bufPtr;
+      return parseError(ILLEGAL_WSPACE);
+   }
+   return parseError(MISSING_SPACE);
+}
+
+// A missing newline at the very end of the file is tolerated
+static bool
+readNewline()
+{
+   setColNo(bufPtr);
+   if (bufPtr == bufEnd) return true;
+   if (*bufPtr == '\n') {
+      lineBeg = ++bufPtr;
+      ++lineNo;
+      return true;
+   }
+   if (*bufPtr != ' ' && isspace((unsigned char)*bufPtr)) {
+      errInt = *bufPtr;
+      return parseError(ILLEGAL_WSPACE);
+   }
+   return parseError(MISSING_NEWLINE);
+}
+
+// Check the literal that defines a PI or an AIG (colNo set by caller)
+static bool
+checkDefLit(int lit, int maxId, CirGate *prev, const string& type)
+{
+   errInt = lit;
+   if (lit / 2 == 0) return parseError(REDEF_CONST);
+   if (lit / 2 > maxId) return parseError(MAX_LIT_ID);
+   if (lit & 1) { errMsg = type; return parseError(CANNOT_INVERTED); }
+   if (prev) { errGate = prev; return parseError(REDEF_GATE); }
+   return true;
+}
+
+static bool
+checkFaninLit(int lit, int maxId)
+{
+   errInt = lit;
+   if (lit / 2 > maxId) return parseError(MAX_LIT_ID);
+   return true;
+}
+
+// Decode one unsigned LEB128 number of the binary AND section:
+// 7 bits per byte, least significant group first, MSB = continuation
+static bool
+readDelta(unsigned& delta)
+{
+   delta = 0;
+   for (unsigned shift = 0; ; shift += 7) {
+      if (bufPtr == bufEnd) {
+         errMsg = "AIG";
+         return parseError(MISSING_DEF);
+      }
+      unsigned char c = *bufPtr++;
+      if (shift > 28 || (shift == 28 && (c & 0x70))) {
+         errMsg = "AIG delta encoding";
+         return parseError(ILLEGAL_NUM);
+      }
+      delta |= (unsigned)(c & 0x7f) << shift;
+      if (!(c & 0x80)) return true;
+   }
+}
 /**************************************************************/
 /*   class CirMgr member functions for circuit construction   */
 /**************************************************************/
 
 bool
-CirMgr::readCircuit(const string& fileName)
+CirMgr::readCircuit(const string& fileName, bool verbose)
 {
-   fstream fp;
-   fp.open(fileName, ios::in);
-   lineNo = 0;
+   MyMmapFile mf;
    // check file is opened
-   if (!fp.is_open()) {
+   if (!mf.open(fileName)) {
       cerr << "Cannot open design \"" << fileName << "\"!!" << endl;
       return false;
    }
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   bufPtr = lineBeg = mf.begin();
+   bufEnd = mf.end();
+   lineNo = colNo = 0;
 
    // vector that record the input information
    vector<int> po;
    vector<pair<int,int>> aig;
 
    // call helper function
-   if (!readHeader(fp))
+   if (!readHeader())
       return false;
-   readInputDef(fp);
-   readOutputDef(fp, po);
-   readAIGDef(fp, aig);
-   readSymbol(fp);
-
-   fp.close();
-   // connect circuit
-   connect(po, aig);
-   
-   string enum_str[5] = {"UNDEF_GATE", "PI_GATE", "PO_GATE", "AIG_GATE", "CONST_GATE"};
-   // try to print
-   // cout << "below is the vecotr-Graph inside" << endl;
-   // for (int i = 0; i < CirCuit.size(); i++) {
-   //    cout << "[" << i << "] ";
-   //    printf("gateIdx(%d) ", CirCuit[i]->gateId);
-   //    for (int j = 0; j < CirCuit[i]->fanIn.size(); j++)
-   //       printf("fanIn[%d]=%d, ", j, CirCuit[i]->fanIn[j]->gateId);
-   //    printf("\n");
-   // }
+   if (binaryAig) {
+      // gates are created and connected while decoding
+      if (!readBinaryDef() || !readSymbol())
+         return false;
+   }
+   else {
+      if (!readInputDef() || !readOutputDef(po) || !readAIGDef(aig) ||
+          !readSymbol())
+         return false;
+      // connect circuit
+      connect(po, aig);
+   }
+   double parseSec = chrono::duration<double>(
+                        chrono::steady_clock::now() - start).count();
    
    // construct netlist
    unordered_set<CirGate *> visted;
@@ -224,90 +345,300 @@ CirMgr::readCircuit(const string& fileName)
    sort(with_float.begin(), with_float.end());
    
    delCirIdHash = new bool[MILOA[0] + MILOA[3] + 1] {false};
+
+   if (verbose) {
+      double sec = chrono::duration<double>(
+                      chrono::steady_clock::now() - start).count();
+      double mb = mf.size() / 1048576.0;
+      cout << "Read " << fixed << setprecision(2) << mb << " MB: parsed in "
+           << setprecision(4) << parseSec << " s ("
+           << setprecision(1) << (parseSec > 0? mb / parseSec: 0.0)
+           << " MB/s), loaded in " << setprecision(4) << sec << " s ("
+           << setprecision(1) << (sec > 0? mb / sec: 0.0) << " MB/s)"
+           << defaultfloat << endl;
+   }
    return true;
 }
 
 bool 
-CirMgr::readHeader(fstream& fstr)
+CirMgr::readHeader()
 {
-   string str;
+   static const string numName[5] = { "number of variables",
+      "number of PIs", "number of latches", "number of POs",
+      "number of AIGs" };
 
-   lineNo++;
+   // read "aag" (ASCII) or "aig" (binary)
+   const char *fileBeg = bufPtr, *p = bufPtr;
+   while (p != bufEnd && !isspace((unsigned char)*p)) ++p;
+   if (p == bufPtr) {
+      setColNo(bufPtr);
+      if (bufPtr != bufEnd && *bufPtr == ' ')
+         return parseError(EXTRA_SPACE);
+      errMsg = "aag";
+      return parseError(MISSING_IDENTIFIER);
+   }
+   string ident(bufPtr, p);
+   if (ident != "aag" && ident != "aig") {
+      errMsg = ident;
+      return parseError(ILLEGAL_IDENTIFIER);
+   }
+   binaryAig = (ident == "aig");
+   bufPtr = p;
 
-   fstr >> str; // read "aag"
-   if (str != "aag") {
-      cerr << "[ERROR] Line " << lineNo << ": Illegal identifier \"" << str << "\"!!" << endl;
+   for (int i = 0; i < 5; i++) // read M I L O A
+      if (!readSpace() || !readNum(MILOA[i], numName[i]))
+         return false;
+   if (!readNewline())
       return false;
+
+   if (MILOA[2] != 0) {
+      --lineNo;
+      errMsg = "Number of latches";
+      errInt = MILOA[2];
+      return parseError(NUM_TOO_BIG);
    }
-   for (int i = 0; i < 5; i++) // read M I L O A
-      fstr >> MILOA[i];
+   // the fields may be anything up to INT_MAX, so sum in size_t
+   const size_t nPI = MILOA[1], nPO = MILOA[3], nAig = MILOA[4];
+   if ((size_t)MILOA[0] < nPI + MILOA[2] + nAig) {
+      --lineNo;
+      errMsg = "Number of variables";
+      errInt = MILOA[0];
+      return parseError(NUM_TOO_SMALL);
+   }
+   // gates are numbered up to M + O, and their literals must be ints
+   if ((binaryAig && (size_t)MILOA[0] > nPI + nAig) ||
+       (size_t)MILOA[0] + nPO > INT_MAX / 2) {
+      --lineNo;
+      errMsg = "Number of variables";
+      errInt = MILOA[0];
+      return parseError(NUM_TOO_BIG);
+   }
+
+   // only hints, capped by the file size (a PO or AIG takes at least 2
+   // bytes), so that a bad header cannot reserve more
+   const size_t cap = (bufEnd - fileBeg) / 2 + 1;
+   const size_t nGate = std::min(nPI, cap) + std::min(nPO, cap) +
+                        std::min(nAig, cap);
+   CirCuit.reserve(1 + nGate);
+   _gatePool.reserve(nGate);
+   Map.reserve(1 + nGate);
    return true;
 }
 bool 
-CirMgr::readInputDef(fstream& fstr)
+CirMgr::readInputDef()
 {
    int num, gateID;
 
    for (int i = 0; i < MILOA[1]; i++) {
-      fstr >> num;
-      assert(num%2 == 0);
+      if (bufPtr == bufEnd) {
+         errMsg = "PI";
+         return parseError(MISSING_DEF);
+      }
+      const char *tok = bufPtr;
+      if (!readNum(num, "PI literal ID"))
+         return false;
+      setColNo(tok);
       gateID = num/2;
-      CirGate *c = new CirGate(PI_GATE, gateID, ++lineNo, 1);
+      if (!checkDefLit(num, MILOA[0], getGate(gateID), "PI"))
+         return false;
+      CirGate *c = _gatePool.alloc(PI_GATE, gateID, lineNo + 1, 1);
 
       Map[gateID] = c;
       CirCuit.push_back(c);
+      if (!readNewline())
+         return false;
    }
    return true;
 }
 bool 
-CirMgr::readOutputDef(fstream& fstr, vector<int>& po)
+CirMgr::readOutputDef(vector<int>& po)
 {
    int num, gateID;
 
    for (int i = 1; i <= MILOA[3]; i++) {
-      fstr >> num;
+      if (bufPtr == bufEnd) {
+         errMsg = "PO";
+         return parseError(MISSING_DEF);
+      }
+      const char *tok = bufPtr;
+      if (!readNum(num, "PO literal ID"))
+         return false;
+      setColNo(tok);
+      if (!checkFaninLit(num, MILOA[0]))
+         return false;
       gateID = MILOA[0] + i;
-      CirGate *c = new CirGate(PO_GATE, gateID, ++lineNo, 1);
+      CirGate *c = _gatePool.alloc(PO_GATE, gateID, lineNo + 1, 1);
       po.push_back(num);
 
       Map[gateID] = c;
       CirCuit.push_back(c);
+      if (!readNewline())
+         return false;
    }
    return true;
 }
 bool 
-CirMgr::readAIGDef(fstream& fstr, vector<pair<int,int>>& aig)
+CirMgr::readAIGDef(vector<pair<int,int>>& aig)
 {
    int num, fanin1, fanin2, gateID;
 
+   aig.reserve(MILOA[4]);
    for (int i = 0; i < MILOA[4]; i++) {
-      fstr >> num >> fanin1 >> fanin2;
-      assert(num%2 == 0);
+      if (bufPtr == bufEnd) {
+         errMsg = "AIG";
+         return parseError(MISSING_DEF);
+      }
+      const char *tok = bufPtr;
+      if (!readNum(num, "AIG literal ID"))
+         return false;
+      setColNo(tok);
       gateID = num/2;
-      CirGate *c = new CirGate(AIG_GATE, gateID, ++lineNo, 1);
+      if (!checkDefLit(num, MILOA[0], getGate(gateID), "AIG"))
+         return false;
+      for (int j = 0; j < 2; ++j) {
+         int& fanin = (j == 0)? fanin1: fanin2;
+         if (!readSpace()) return false;
+         tok = bufPtr;
+         if (!readNum(fanin, "AIG input literal ID"))
+            return false;
+         setColNo(tok);
+         if (!checkFaninLit(fanin, MILOA[0]))
+            return false;
+      }
+      CirGate *c = _gatePool.alloc(AIG_GATE, gateID, lineNo + 1, 1);
       aig.push_back(pair<int,int>(fanin1, fanin2));
 
       Map[gateID] = c;
       CirCuit.push_back(c);
+      if (!readNewline())
+         return false;
    }
    return true;
 }
+// Binary AIGER: PIs are implicit (2, 4, ..., 2I), POs are ASCII lines
+// and each AND is two LEB128 deltas (lhs - rhs0, rhs0 - rhs1) with an
+// implicit lhs of 2(I+i+1). Since M == I + A, every gate is known up
+// front, so the fanins are connected while decoding without going
+// through Map or connect(). Gate lines are those of the equivalent aag.
 bool
-CirMgr::readSymbol(fstream& fstr)
+CirMgr::readBinaryDef()
+{
+   int numPI = MILOA[1], numPO = MILOA[3], numAIG = MILOA[4];
+   int aigBase = numPI + numPO;   // CirCuit[aigBase + k] is AIG (numPI + k)
+
+   CirCuit.resize(1 + numPI + numPO + numAIG);
+   for (int i = 1; i <= numPI; i++) {
+      CirCuit[i] = _gatePool.alloc(PI_GATE, i, i + 1, 1);
+      Map[i] = CirCuit[i];
+   }
+   for (int i = 1; i <= numAIG; i++) {
+      CirCuit[aigBase + i] = _gatePool.alloc(AIG_GATE, numPI + i,
+                                         1 + numPI + numPO + i, 1);
+      Map[numPI + i] = CirCuit[aigBase + i];
+   }
+   for (int i = 1; i <= numPO; i++) {
+      CirCuit[numPI + i] = _gatePool.alloc(PO_GATE, MILOA[0] + i,
+                                       1 + numPI + i, 1);
+      Map[MILOA[0] + i] = CirCuit[numPI + i];
+   }
+
+   // PO lines (the fanins are all defined gates)
+   lineNo = numPI + 1;
+   for (int i = 1; i <= numPO; i++) {
+      int lit;
+      if (bufPtr == bufEnd) {
+         errMsg = "PO";
+         return parseError(MISSING_DEF);
+      }
+      const char *tok = bufPtr;
+      if (!readNum(lit, "PO literal ID"))
+         return false;
+      setColNo(tok);
+      if (!checkFaninLit(lit, MILOA[0]))
+         return false;
+      int id = lit / 2;
+      addFanin(CirCuit[numPI + i],
+               CirCuit[id <= numPI? id: numPO + id], lit & 1);
+      if (!readNewline())
+         return false;
+   }
+
+   // delta-encoded AND section
+   for (int i = 1; i <= numAIG; i++) {
+      unsigned lhs = 2 * (numPI + i), d0, d1;
+      if (!readDelta(d0) || !readDelta(d1))
+         return false;
+      if (d0 == 0 || d0 > lhs || d1 > lhs - d0) {
+         errMsg = "AIG delta encoding";
+         return parseError(ILLEGAL_NUM);
+      }
+      unsigned lit[2] = { lhs - d0, lhs - d0 - d1 };
+      CirGate *gate = CirCuit[aigBase + i];
+      for (int j = 0; j < 2; ++j) {
+         int id = lit[j] / 2;
+         addFanin(gate, CirCuit[id <= numPI? id: numPO + id], lit[j] & 1);
+      }
+      ++lineNo;
+   }
+   // symbols (if any) start right after the binary section
+   lineBeg = bufPtr;
+   return true;
+}
+bool
+CirMgr::readSymbol()
 {
    // [ilo][position] <symbolic name>
-   string str, name;
    int num, gateIdx;
 
-   while (fstr >> str && str[0] != 'c') {
-      num = stoi(str.substr(1));
-      gateIdx = (str[0] == 'i')?(num+1):(MILOA[1] + num + 1);
-
-      getline(fstr, name);
-      name.erase(0, name.find_first_not_of(" "));
+   while (bufPtr != bufEnd && *bufPtr != 'c') {
+      char type = *bufPtr;
+      setColNo(bufPtr);
+      if (type != 'i' && type != 'o') {
+         if (type == ' ')
+            return parseError(EXTRA_SPACE);
+         if (isspace((unsigned char)type)) {
+            errInt = type;
+            return parseError(ILLEGAL_WSPACE);
+         }
+         errMsg = type;
+         return parseError(ILLEGAL_SYMBOL_TYPE);
+      }
+      ++bufPtr;
+      if (!readNum(num, "symbol index"))
+         return false;
+      if (num >= MILOA[type == 'i'? 1: 3]) {
+         errMsg = (type == 'i')? "PI index": "PO index";
+         errInt = num;
+         return parseError(NUM_TOO_BIG);
+      }
+      if (!readSpace())
+         return false;
 
-      CirCuit[gateIdx]->name = name;
+      const char *p = bufPtr;
+      while (p != bufEnd && *p != '\n') {
+         if (!isprint((unsigned char)*p)) {
+            setColNo(p);
+            errInt = *p;
+            return parseError(ILLEGAL_SYMBOL_NAME);
+         }
+         ++p;
+      }
+      if (p == bufPtr) {
+         errMsg = "symbolic name";
+         return parseError(MISSING_IDENTIFIER);
+      }
+      gateIdx = (type == 'i')?(num+1):(MILOA[1] + num + 1);
+      if (!CirCuit[gateIdx]->name.empty()) {
+         errMsg = type;
+         errInt = num;
+         return parseError(REDEF_SYMBOLIC_NAME);
+      }
+      CirCuit[gateIdx]->name.assign(bufPtr, p);
+      bufPtr = p;
+      if (!readNewline())
+         return false;
    }
+   // the comment section is not interpreted
    return true;
 }
 
@@ -322,12 +653,13 @@ CirMgr::connect(vector<int>& po, vector<pair<int,int>>& aig)
 
       thisGate = CirCuit[MILOA[1] + i + 1];
 
-      if(Map.find(fanInId) == Map.end()) { // UNDEF_GATE
-         fanInGate = new CirGate(UNDEF_GATE, fanInId, 0, 0);
+      unordered_map<int,CirGate *>::iterator it = Map.find(fanInId);
+      if(it == Map.end()) { // UNDEF_GATE
+         fanInGate = _gatePool.alloc(UNDEF_GATE, fanInId, 0, 0);
          CirCuit.push_back(fanInGate);
          Map[fanInId] = fanInGate;
       } else {
-         fanInGate = Map[fanInId];
+         fanInGate = it->second;
       }
       isflo = (fanInGate->gateType == UNDEF_GATE);
       thisGate->fanIn.push_back(fanInGate);
@@ -339,18 +671,20 @@ CirMgr::connect(vector<int>& po, vector<pair<int,int>>& aig)
    }
    // handle aig
    for (int i = 0; i < MILOA[4]; i++) {
+      unordered_map<int,CirGate *>::iterator it;
       CirGate *fanInGate, *thisGate;
       int fanInId[2] = {aig[i].first/2, aig[i].second/2};
       bool isflo;
 
       thisGate = CirCuit[MILOA[1] + MILOA[3] + i + 1];
       // handle fanIn1
-      if(Map.find(fanInId[0]) == Map.end()) { // UNDEF_GATE
-         fanInGate = new CirGate(UNDEF_GATE, fanInId[0], 0, 0);
+      it = Map.find(fanInId[0]);
+      if(it == Map.end()) { // UNDEF_GATE
+         fanInGate = _gatePool.alloc(UNDEF_GATE, fanInId[0], 0, 0);
          CirCuit.push_back(fanInGate);
          Map[fanInId[0]] = fanInGate;
       } else {
-         fanInGate = Map[fanInId[0]];
+         fanInGate = it->second;
       }
       isflo = (fanInGate->gateType == UNDEF_GATE);
       thisGate->fanIn.push_back(fanInGate);
@@ -360,12 +694,13 @@ CirMgr::connect(vector<int>& po, vector<pair<int,int>>& aig)
       fanInGate->fanOut.push_back(thisGate);
       fanInGate->fanOut_inv.push_back(aig[i].first & 1);
       // handle fanIn2
-      if(Map.find(fanInId[1]) == Map.end()) { // UNDEF_GATE
-         fanInGate = new CirGate(UNDEF_GATE, fanInId[1], 0, 0);
+      it = Map.find(fanInId[1]);
+      if(it == Map.end()) { // UNDEF_GATE
+         fanInGate = _gatePool.alloc(UNDEF_GATE, fanInId[1], 0, 0);
          CirCuit.push_back(fanInGate);
          Map[fanInId[1]] = fanInGate;
       } else {
-         fanInGate = Map[fanInId[1]];
+         fanInGate = it->second;
       }
       isflo = (fanInGate->gateType == UNDEF_GATE);
       thisGate->fanIn.push_back(fanInGate);
@@ -395,6 +730,7 @@ CirMgr::genNetList(CirGate *gate, unordered_set<CirGate *>& visted)
 
    visted.insert(gate);
    netList.push_back(gate);
+   _aigDirty = true;
    return;
 }
 
@@ -500,86 +836,188 @@ CirMgr::printFECPairs() const
    for (int i = 0; i < fecSize; ++i) {
       int groupSize = fecGroup[i].size();
       assert(groupSize > 1);
-      bitset<PatternSIZE> compValue = cirMgr->Map[fecGroup[i][0]]->gateValue;
+      unsigned phase = fecGroup[i][0] & 1;
 
       cout << "[" << i << "]";
       for (int j = 0; j < groupSize; ++j) {
-         int curId = fecGroup[i][j];
+         unsigned lit = fecGroup[i][j];
          cout << ' ';
-         if (cirMgr->Map[curId]->gateValue != compValue) cout << '!';
-         cout << curId;
+         if ((lit & 1) != phase) cout << '!';
+         cout << (lit >> 1);
       }
       cout << endl;
    }
 }
 
+// Output is assembled in one string and written with a single call;
+// integers are formatted by hand instead of going through ostream.
+static inline void
+appendUInt(string& buf, unsigned n)
+{
+   char tmp[10];
+   int len = 0;
+   do { tmp[len++] = '0' + n % 10; n /= 10; } while (n);
+   while (len) buf += tmp[--len];
+}
+
+// LEB128 as used in the binary AND section (see readDelta())
+static inline void
+appendDelta(string& buf, unsigned d)
+{
+   while (d & ~0x7fu) {
+      buf += (char)((d & 0x7f) | 0x80);
+      d >>= 7;
+   }
+   buf += (char)d;
+}
+
 void
 CirMgr::writeAag(ostream& outfile) const
 {
-   #define pii pair<int,int>
-   #define piii pair<int,pair<int,int>>
-   vector<string> pi_sym;
-   vector<string> po_sym;
-   vector<piii> aig;
-   int lb, hb;
-
-   // traverse netlist to get symbol & aig
+   string buf;
+   int nAig = 0;
+
+   // traverse netlist to count the reachable aig
    int nsize = netList.size();
-   for (int i = 0; i < nsize; i++) {
-      if (netList[i]->gateType == AIG_GATE) {
-         int n1 = 2*netList[i]->gateId;
-         int n2 = 2*netList[i]->fanIn[0]->gateId
-                  + (int)netList[i]->fanIn_inv[0];
-         int n3 = 2*netList[i]->fanIn[1]->gateId
-                  + (int)netList[i]->fanIn_inv[1];
-         aig.push_back(piii(n1, pii(n2, n3)));
-      }
-   }
+   for (int i = 0; i < nsize; i++)
+      if (netList[i]->gateType == AIG_GATE) ++nAig;
+   buf.reserve(64 + 12 * (MILOA[1] + MILOA[3] + 3 * nAig));
 
-   outfile << "aag";
-   for (int i = 0; i < 4; i++)
-      outfile << " " << MILOA[i];
-   outfile << " " << aig.size();
-   outfile << endl;
+   buf += "aag";
+   for (int i = 0; i < 4; i++) {
+      buf += ' ';
+      appendUInt(buf, MILOA[i]);
+   }
+   buf += ' ';
+   appendUInt(buf, nAig);
+   buf += '\n';
 
    // pi
    for (int i = 1; i <= MILOA[1]; i++) {
-      outfile << 2*CirCuit[i]->gateId << endl;
-      // pi_sym
-      if (!CirCuit[i]->name.empty())
-         pi_sym.push_back(CirCuit[i]->name);
+      appendUInt(buf, 2*CirCuit[i]->gateId);
+      buf += '\n';
    }
 
    // po
-   lb = MILOA[1] + 1;
-   hb = MILOA[1] + 1 + MILOA[3];
-   for (int i = lb; i < hb; i++) {
-      int po_value = 2*CirCuit[i]->fanIn[0]->gateId
-                  + (int)CirCuit[i]->fanIn_inv[0];
-      outfile << po_value << endl;
-      // po_sym
-      if (!CirCuit[i]->name.empty())
-         po_sym.push_back(CirCuit[i]->name);
+   for (int i = MILOA[1] + 1; i <= MILOA[1] + MILOA[3]; i++) {
+      appendUInt(buf, 2*CirCuit[i]->fanIn[0]->gateId
+                      + (int)CirCuit[i]->fanIn_inv[0]);
+      buf += '\n';
    }
 
    // aig
-   nsize = aig.size();
    for (int i = 0; i < nsize; i++) {
-      outfile << aig[i].first << " ";
-      outfile << aig[i].second.first << " ";
-      outfile << aig[i].second.second << endl;
+      const CirGate *g = netList[i];
+      if (g->gateType != AIG_GATE) continue;
+      appendUInt(buf, 2*g->gateId);
+      for (int j = 0; j < 2; ++j) {
+         buf += ' ';
+         appendUInt(buf, 2*g->fanIn[j]->gateId + (int)g->fanIn_inv[j]);
+      }
+      buf += '\n';
    }
 
-   nsize = pi_sym.size();
-   for (int i = 0; i < nsize; i++)
-      outfile << "i" << i << " " << pi_sym[i] << endl;
+   writeSymbol(buf);
+   buf += "c\nAAG output by EricTT\n";
+   outfile.write(buf.data(), buf.size());
+   outfile.flush();
+}
 
-   nsize = po_sym.size();
+// Binary AIGER needs PIs numbered 1..I and ANDs numbered I+1..I+A in
+// topological order with lhs > rhs0 >= rhs1, so the reachable ANDs are
+// renumbered in netList (DFS) order. Floating fanins cannot be
+// expressed; CIRWrite rejects such a circuit (see dfsFloatNum()).
+void
+CirMgr::writeAig(ostream& outfile) const
+{
+   unordered_map<int, unsigned> newId;   // gateId -> aig variable
+   int nAig = 0;
+   string buf;
+
+   newId.reserve(1 + MILOA[1] + netList.size());
+   newId[0] = 0;
+   for (int i = 1; i <= MILOA[1]; i++)
+      newId[CirCuit[i]->gateId] = i;
+   int nsize = netList.size();
    for (int i = 0; i < nsize; i++)
-      outfile << "o" << i << " " << po_sym[i] << endl;
+      if (netList[i]->gateType == AIG_GATE)
+         newId[netList[i]->gateId] = MILOA[1] + (++nAig);
+   buf.reserve(64 + 12 * MILOA[3] + 4 * nAig);
 
-   outfile << "c" << endl;
-   outfile << "AAG output by EricTT" << endl;
+   // literal of a fanin in the renumbered graph
+   auto faninLit = [&](const CirGate *g, int j) -> unsigned {
+      unordered_map<int, unsigned>::const_iterator it =
+         newId.find(g->fanIn[j]->gateId);
+      assert(it != newId.end());
+      return 2 * it->second + (unsigned)g->fanIn_inv[j];
+   };
+
+   buf += "aig ";
+   appendUInt(buf, MILOA[1] + nAig);
+   buf += ' ';
+   appendUInt(buf, MILOA[1]);
+   buf += " 0 ";
+   appendUInt(buf, MILOA[3]);
+   buf += ' ';
+   appendUInt(buf, nAig);
+   buf += '\n';
+
+   // po
+   for (int i = MILOA[1] + 1; i <= MILOA[1] + MILOA[3]; i++) {
+      appendUInt(buf, faninLit(CirCuit[i], 0));
+      buf += '\n';
+   }
+
+   // aig, as deltas
+   for (int i = 0; i < nsize; i++) {
+      const CirGate *g = netList[i];
+      if (g->gateType != AIG_GATE) continue;
+      unsigned lhs = 2 * newId[g->gateId];
+      unsigned r0 = faninLit(g, 0), r1 = faninLit(g, 1);
+      if (r0 < r1) swap(r0, r1);
+      assert(lhs > r0);
+      appendDelta(buf, lhs - r0);
+      appendDelta(buf, r0 - r1);
+   }
+
+   writeSymbol(buf);
+   buf += "c\nAIG output by EricTT\n";
+   outfile.write(buf.data(), buf.size());
+   outfile.flush();
+}
+
+// Number of floating fanins of the gates in netList, i.e. in the output
+// of writeAag()/writeAig()
+int
+CirMgr::dfsFloatNum() const
+{
+   int n = 0;
+   for (const CirGate *g : netList)
+      for (const CirGate *fi : g->fanIn)
+         if (fi->gateType == UNDEF_GATE) ++n;
+   return n;
+}
+
+void
+CirMgr::writeSymbol(string& buf) const
+{
+   for (int i = 1; i <= MILOA[1]; i++) {
+      if (CirCuit[i]->name.empty()) continue;
+      buf += 'i';
+      appendUInt(buf, i - 1);
+      buf += ' ';
+      buf += CirCuit[i]->name;
+      buf += '\n';
+   }
+   for (int i = 1; i <= MILOA[3]; i++) {
+      const CirGate *g = CirCuit[MILOA[1] + i];
+      if (g->name.empty()) continue;
+      buf += 'o';
+      appendUInt(buf, i - 1);
+      buf += ' ';
+      buf += g->name;
+      buf += '\n';
+   }
 }
 // TODO
 void
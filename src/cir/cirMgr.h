@@ -17,7 +17,7 @@
 #include <unordered_set>
 #include <algorithm>
 #include <set>
-#include <bitset>
+#include <cstring>
 
 using namespace std;
 
@@ -25,21 +25,50 @@ using namespace std;
 
 #include "cirDef.h"
 #include "cirGate.h"
+#include "myMmap.h"
+#include "myPool.h"
+#include "myThread.h"
 
 extern CirMgr *cirMgr;
 
+// Per-thread state of CirMgr::faultDetect(); the faulty values are kept
+// in slots of "val", allocated in the order the gates change
+struct FaultWork
+{
+   vector<unsigned>          stamp;   // == epoch: gid has a faulty value
+   vector<unsigned>          queued;  // == epoch: gid is in a queue
+   vector<unsigned>          slot;
+   vector<ull>               val;
+   vector<ull>               tmp;
+   vector<vector<unsigned> > queue;   // per level
+   unsigned                  epoch;
+};
+
 class CirMgr
 {
 public:
-   CirMgr()
+   CirMgr() : _simLog(0), _simLogBinary(false),
+              _simArena(0), _simScratch(0), _simArenaGates(0),
+              _simWords(PatternSIZE / 64), _simLevelized(false),
+              _simIncremental(false), _simPrevCone(false), _simPrevWords(0),
+              _simPrevX(false), _simSeed(0),
+              _simStallRounds(0), _simMaxPatterns(0), _simTimeout(0),
+              _simConeFec(false), _simConeOn(false), _simConeMembers(0),
+              _simX(false), _simZeroArena(0), _simXNum(0), _faultOn(false),
+              _statOn(false), _statSlice(0), _statPatterns(0),
+              _wgtOn(false), _wgtAuto(false), _wgtBiased(0),
+              _aigDirty(true), _fecPairs(0), _fecFresh(false),
+              _fecExact(false), delCirIdHash(0)
    { 
-      CirCuit.push_back(new CirGate(CONST_GATE, 0, 0, 0)); 
+      CirCuit.push_back(_gatePool.alloc(CONST_GATE, 0, 0, 0)); 
       Map[0] = CirCuit[0]; 
    }
    ~CirMgr() 
    {
       for (CirGate* cptr : CirCuit)
-         delete cptr;
+         _gatePool.free(cptr);
+      freeSimArena();
+      delete [] delCirIdHash;
    }
 
    // Access functions
@@ -52,7 +81,7 @@ public:
    }
 
    // Member functions about circuit construction
-   bool readCircuit(const string&);
+   bool readCircuit(const string&, bool verbose = false);
 
    // Member functions about circuit optimization
    void sweep();
@@ -60,8 +89,54 @@ public:
 
    // Member functions about simulation
    void randomSim();
-   void fileSim(ifstream&);
-   void setSimLog(ofstream *logFile) { _simLog = logFile; }
+   bool fileSim(const string&);
+   bool exhaustiveSim();
+   static bool packPatterns(const string&, const string&);
+   void setSimLog(ofstream *logFile, bool binary = false) {
+      _simLog = logFile; _simLogBinary = binary;
+   }
+   bool setSimLogRef(const string&);
+   void setSimWidth(size_t);
+   size_t getSimWidth() const { return _simWords * 64; }
+   void setSimThreads(size_t n) { _simPool.resize(n); }
+   void setSimLevelized(bool l) { _simLevelized = l; }
+   void setSimIncremental(bool i) { _simIncremental = i; }
+   void setSimSeed(ull seed) { _simSeed = seed; }
+   // stallRounds = 0 turns adaptive stopping off; 0 budgets are unlimited
+   void setSimAdaptive(unsigned stallRounds, size_t maxPatterns,
+                       unsigned timeout) {
+      _simStallRounds = stallRounds;
+      _simMaxPatterns = maxPatterns;
+      _simTimeout = timeout;
+   }
+   // simulate the fanin cone of "roots" (gateIds), or of the FEC
+   // candidates if "fec"; no roots and !fec simulates everything
+   void setSimCone(const vector<unsigned>& roots, bool fec) {
+      _simConeRoot = roots;
+      _simConeFec = fec;
+      _simConeOn = fec || !roots.empty();
+   }
+   // stuck-at fault simulation of every batch, see cirFault.cpp
+   void setSimFault(bool f) { _faultOn = f; }
+   // three-valued (0/1/X) simulation, see simulateWordsX()
+   void setSimX(bool x) { _simX = x; }
+   // signal statistics, written to "file" unless it is ""
+   void setSimStats(bool s, const string& file = "") {
+      _statOn = s; _statFile = file;
+   }
+   // weighted random patterns for randomSim(): the weight sets in "file",
+   // or derived from signal probabilities if it is ""; see cirWeight.cpp
+   bool setSimWeights(bool w, const string& file = "");
+   // turn off the settings above that last for one command only
+   void resetSimOptions() {
+      setSimLog(0);
+      setSimLogRef("");
+      setSimCone(vector<unsigned>(), false);
+      setSimFault(false);
+      setSimX(false);
+      setSimStats(false);
+      setSimWeights(false);
+   }
    void simulate();
 
    // Member functions about fraig
@@ -77,21 +152,151 @@ public:
    void printFloatGates() const;
    void printFECPairs() const;
    void writeAag(ostream&) const;
+   void writeAig(ostream&) const;
+   int dfsFloatNum() const;
    void writeGate(ostream&, CirGate*) const;
 
+   // Member functions about checkpoints
+   bool writeCheckpoint(const string&, int cmdState, bool withSig) const;
+   bool readCheckpoint(const string&, int& cmdState);
+
    friend class CirGate;
 
 private:
    ofstream           *_simLog;
+   bool                _simLogBinary;
+   MyMmapFile          _simLogRef;     // compared by simOutput() if open
+   const char         *_simLogRefPos;
+   size_t              _simLogDiffNum;
+   string              _simLogBuf;
+
+   // simulation values: _simWords words per gate, indexed by gateId
+   ull                *_simArena;
+   ull                *_simScratch;
+   size_t              _simArenaGates;
+   size_t              _simWords;
+   MyThreadPool        _simPool;
+   bool                _simLevelized;   // level-parallel, see simulate()
+   bool                _simIncremental; // event-driven, see simulate()
+   vector<ull>         _simPiPrev;      // PI words of the last batch
+   bool                _simPrevCone;    // ... of which only a cone was run
+   size_t              _simPrevWords;   // ... at this width
+   bool                _simPrevX;       // ... in three-valued mode
+   ull                 _simSeed;        // for randomSim()
+   unsigned            _simStallRounds; // adaptive randomSim() stopping
+   size_t              _simMaxPatterns;
+   unsigned            _simTimeout;     // seconds
+   vector<vector<unsigned> > _simEvQueue;  // per-level event queue
+   vector<unsigned char>     _simEvMark;
+   // cone-restricted simulation, see buildSimCone()
+   vector<unsigned>      _simConeRoot;
+   bool                  _simConeFec;     // cone of the FEC candidates
+   bool                  _simConeOn;
+   size_t                _simConeMembers;
+   vector<unsigned char> _simConeMark;
+   vector<unsigned>      _simConeOrder;
+   vector<unsigned>      _simConeLevelOrder;
+   vector<unsigned>      _simConeLevelOffset;
+   vector<unsigned>      _simConePO;
+   // three-valued simulation: 0 plane, gates seen with X
+   bool                  _simX;
+   ull                  *_simZeroArena;
+   vector<bool>          _simXGone;
+   size_t                _simXNum;
+   void initSimArena();
+   void freeSimArena();
+   void simBegin();
+   void simBatchDone(int);
+   void simEnd(bool exact = false);
+   bool simPrevValid() const;
+   void buildSimCone();
+   int simConePINum();
+   void simulateWords(size_t, size_t, ull* stat = 0);
+   void simulateWordsX(size_t, size_t);
+   void simulatePO(unsigned, size_t, size_t);
+   void simulateAll();
+   void simulateLevels();
+   size_t simulateEvents();
+   ull* simValue(int gid) { return _simArena + gid * _simWords; }
+   const ull* simValue(int gid) const { return _simArena + gid * _simWords; }
+   ull* simZero(int gid) { return _simZeroArena + gid * _simWords; }
+   // stuck-at fault simulation (see cirFault.cpp)
+   bool                  _faultOn;
+   vector<unsigned>      _faultList;
+   vector<FaultWork>     _faultWork;     // per thread
+   size_t                _faultTotal;
+   size_t                _faultCollapsed;
+   size_t                _faultDetected;
+   size_t                _faultEvals;
+   double                _faultSecs;
+   void faultBegin();
+   bool faultDetect(FaultWork&, unsigned, size_t, ull) const;
+   void faultSimulate(int);
+   void faultReport() const;
+   // signal statistics (see statBegin())
+   bool                  _statOn;
+   string                _statFile;
+   vector<unsigned>      _statGate;
+   vector<ull>           _statOnes;
+   vector<ull>           _statToggles;
+   vector<ull>           _statLast;
+   vector<vector<ull> >  _statPart;       // per thread, see statBegin()
+   size_t                _statSlice;
+   size_t                _statPatterns;
+   void statBegin();
+   void statUpdate(int);
+   void statReport() const;
+   // weighted random patterns (see cirWeight.cpp)
+   bool                  _wgtOn;
+   bool                  _wgtAuto;        // sets from wgtFeedback()
+   vector<vector<unsigned char> > _wgtSet;  // per PI, P(1) in 16ths
+   size_t                _wgtBiased;      // rounds with a biased set
+   void wgtFeedback();
+   void wgtFill(const vector<unsigned char>&, int, ull*, ull) const;
+   // dense AIG view of the graph (see cirAig.cpp)
+   vector<unsigned char> _aigType;
+   vector<unsigned>      _aigFanin;
+   vector<unsigned>      _aigFoOffset;
+   vector<unsigned>      _aigFanout;
+   vector<unsigned>      _aigOrder;
+   vector<unsigned>      _aigLevel;
+   vector<unsigned>      _aigLevelOrder;
+   vector<unsigned>      _aigLevelOffset;
+   bool                  _aigDirty;
+   void buildAig();
+   void syncAig() { if (_aigDirty) buildAig(); }
 
-   vector<vector<int> > fecGroup;
+   // FEC partition refinement (see cirFec.cpp)
+   typedef pair<unsigned, unsigned> FecClass;  // (first, size) in _fecLit
+   vector<unsigned>      _fecLit;
+   vector<FecClass>      _fecClass;
+   vector<FecClass>      _fecNext;
+   vector<vector<unsigned> > _fecFrozen;  // outside the simulated cone
+   vector<unsigned>      _fecTable;
+   vector<unsigned>      _fecSub;
+   vector<unsigned>      _fecTmp;
+   vector<unsigned>      _fecSubRep;
+   vector<unsigned>      _fecSubCnt;
+   vector<ull>           _fecSubHash;
+   size_t                _fecPairs;
+   bool                  _fecFresh;
+   bool                  _fecExact;  // fecGroup holds proven classes
+   void fecInit();
+   void fecRefine();
+   void fecRemove(const vector<bool>&);
+   void fecExport(bool exact = false);
+
+   // FEC groups as literals (gateId*2 + phase), sorted by gateId; members
+   // of different phases are complements of each other
+   vector<vector<unsigned> > fecGroup;
    int patternNum;
-   void fecGroupBetter();
    void fecGroupSort_ReId();
    void setFecIdx();
-   void simOutput(string*);
+   void simOutput(int);
+   void simOutputDone();
    
-   // the Graph data
+   // the Graph data; gates are allocated from _gatePool
+   MyPool<CirGate> _gatePool;
    int MILOA[5];
    vector<CirGate *> CirCuit;
    unordered_map<int,CirGate *> Map; // store the cptr in map[gateID]
@@ -99,13 +304,16 @@ private:
    vector<int> with_float;
    vector<int> def_notused;
 
-   // function for parser
-   bool readHeader(fstream& fstr);
-   bool readInputDef(fstream& fstr);
-   bool readOutputDef(fstream& fstr, vector<int>& po);
-   bool readAIGDef(fstream& fstr, vector<pair<int,int>>& aig);
-   bool readSymbol(fstream& fstr);
-   bool readComment(fstream& fstr);
+   // function for parser (scan the memory-mapped file, see cirMgr.cpp)
+   bool readHeader();
+   bool readInputDef();
+   bool readOutputDef(vector<int>& po);
+   bool readAIGDef(vector<pair<int,int>>& aig);
+   bool readBinaryDef();
+   bool readSymbol();
+
+   // function for writer
+   void writeSymbol(string& buf) const;
 
    // delete helper
    bool* delCirIdHash;
@@ -115,7 +323,7 @@ private:
          if (!delCirIdHash[CirCuit[i]->gateId]) continue;
          Map.erase(CirCuit[i]->gateId);
          swap(CirCuit[i], CirCuit[CSize]);
-         delete CirCuit[CSize--];
+         _gatePool.free(CirCuit[CSize--]);
          CirCuit.pop_back();
       }
    }
@@ -139,6 +347,13 @@ private:
 
    // connect
    bool connect(vector<int>& po, vector<pair<int,int>>& aig);
+   void addFanin(CirGate *gate, CirGate *fanin, bool inv) {
+      gate->fanIn.push_back(fanin);
+      gate->fanIn_inv.push_back(inv);
+      gate->fanIn_flo.push_back(fanin->gateType == UNDEF_GATE);
+      fanin->fanOut.push_back(gate);
+      fanin->fanOut_inv.push_back(inv);
+   }
 
    // netList
    void genNetList(CirGate *gate, unordered_set<CirGate *>& visted);
@@ -43,6 +43,12 @@ CirMgr::sweep()
   vector<int> delCirId;
   for (int i = 1; i < cirSize; ++i) {
     if (isInNetList[CirCuit[i]->gateId] || CirCuit[i]->gateType == PI_GATE) continue;
+    // UNDEF gates are never in netList; keep those still used by it
+    bool used = false;
+    if (CirCuit[i]->gateType == UNDEF_GATE)
+      for (CirGate* fo : CirCuit[i]->fanOut)
+        if (isInNetList[fo->gateId]) used = true;
+    if (used) continue;
     delCirId.push_back(i);
   }
 
@@ -69,11 +75,14 @@ CirMgr::sweep()
     if (CirCuit[id]->gateType != AIG_GATE)
       ++notAIG;
   MILOA[4] -= (delSize - notAIG);
+  _aigDirty = true;
+  // unlink all of them first, as they may be fanins of one another
+  for (int id : delCirId)
+    CirCuit[id]->delFi_Fout();
   for (int i = delSize - 1; i >= 0; --i) {
-    CirCuit[delCirId[i]]->delFi_Fout();
     Map.erase(CirCuit[delCirId[i]]->gateId);
     swap(CirCuit[delCirId[i]], CirCuit[--cirSize]);
-    delete CirCuit[cirSize];
+    _gatePool.free(CirCuit[cirSize]);
     CirCuit.pop_back();
   }
 }
@@ -0,0 +1,334 @@
+/****************************************************************************
+  FileName     [ cirSave.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define cir checkpoint (save/load) functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "myMmap.h"
+#include "util.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+// Checkpoint layout (native byte order, every section 8-byte aligned so
+// that the file can be used in place after mmap):
+//
+//    CkptHeader | CkptGate[numGates] | names | fanout[] | fanoutInv[]
+//    | netList[] | with_float[] | def_notused[] | fecOffset[numFec + 1]
+//    | fecMember[] | signature[numGates * sigWords]
+//
+// Gates refer to each other by their index in CirCuit, so loading is a
+// single pass without any Map lookups. FEC members are literals
+// (gateId*2 + phase). Without "-Signature" only the first signature word
+// is kept, to report gate values. With it, the whole simulation
+// value (CirMgr::getSimWidth() bits) is kept. The simulation width is
+// restored either way.
+static const char     CkptMagic[8] = { 'F','R','A','I','G','C','K','P' };
+static const uint32_t CkptVersion  = 3;
+static const uint32_t CkptNoFanin  = 0xffffffffu;
+
+struct CkptHeader
+{
+   char     magic[8];
+   uint32_t version;
+   uint32_t cmdState;
+   uint32_t sigWords;        // 64-bit signature words stored per gate
+   int32_t  patternNum;
+   int32_t  miloa[5];
+   uint32_t numGates;
+   uint32_t numNet;
+   uint32_t numFloat;
+   uint32_t numNotUsed;
+   uint32_t numFec;
+   uint32_t numFecMember;
+   uint32_t simWords;        // simulation width / 64
+   uint64_t nameBytes;
+   uint64_t numFanout;
+   uint64_t numFanoutInv;
+};
+
+struct CkptGate
+{
+   int32_t  id;
+   int32_t  line;
+   int32_t  column;
+   uint32_t type;
+   uint32_t fanin[2];        // (CirCuit index << 2) | flo << 1 | inv
+   uint32_t numFanin;
+   uint32_t numFanout;
+   uint32_t numFanoutInv;
+   uint32_t nameLen;
+};
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+static inline size_t
+alignSize(size_t n)
+{
+   return (n + 7) & ~(size_t)7;
+}
+
+template<class T>
+static inline void
+appendSection(string& buf, const T* data, size_t n)
+{
+   buf.append((const char*)data, n * sizeof(T));
+   buf.resize(alignSize(buf.size()), '\0');
+}
+
+// Cursor over the mapped file; every section is bounds-checked
+struct CkptCursor
+{
+   const char *ptr, *end;
+   template<class T>
+   const T* take(size_t n) {
+      size_t bytes = alignSize(n * sizeof(T));
+      if ((size_t)(end - ptr) < bytes) return 0;
+      const T* ret = (const T*)ptr;
+      ptr += bytes;
+      return ret;
+   }
+};
+
+/*************************************************/
+/*   Public member functions about checkpoints   */
+/*************************************************/
+bool
+CirMgr::writeCheckpoint(const string& fileName, int cmdState,
+                        bool withSig) const
+{
+   size_t numGates = CirCuit.size();
+   unordered_map<const CirGate*, uint32_t> index;
+   index.reserve(numGates);
+   for (size_t i = 0; i < numGates; ++i)
+      index[CirCuit[i]] = i;
+
+   CkptHeader h;
+   memset(&h, 0, sizeof(h));
+   memcpy(h.magic, CkptMagic, sizeof(CkptMagic));
+   h.version = CkptVersion;
+   h.cmdState = cmdState;
+   h.sigWords = withSig? _simWords: 1;
+   h.simWords = _simWords;
+   h.patternNum = patternNum;
+   memcpy(h.miloa, MILOA, sizeof(MILOA));
+   h.numGates = numGates;
+   h.numNet = netList.size();
+   h.numFloat = with_float.size();
+   h.numNotUsed = def_notused.size();
+   h.numFec = fecGroup.size();
+
+   vector<CkptGate> gates(numGates);
+   vector<uint32_t> fanout, net;
+   vector<uint8_t> fanoutInv;
+   string names;
+   for (size_t i = 0; i < numGates; ++i) {
+      const CirGate *g = CirCuit[i];
+      CkptGate& r = gates[i];
+      r.id = g->gateId;
+      r.line = g->line;
+      r.column = g->column;
+      r.type = g->gateType;
+      r.numFanin = g->fanIn.size();
+      assert(r.numFanin <= 2);
+      for (uint32_t j = 0; j < 2; ++j)
+         r.fanin[j] = (j < r.numFanin)?
+            (index[g->fanIn[j]] << 2 | (uint32_t)g->fanIn_flo[j] << 1
+                                     | (uint32_t)g->fanIn_inv[j]):
+            CkptNoFanin;
+      r.numFanout = g->fanOut.size();
+      for (const CirGate *fo : g->fanOut)
+         fanout.push_back(index[fo]);
+      r.numFanoutInv = g->fanOut_inv.size();
+      for (size_t j = 0; j < r.numFanoutInv; ++j)
+         fanoutInv.push_back(g->fanOut_inv[j]);
+      r.nameLen = g->name.size();
+      names += g->name;
+   }
+   h.nameBytes = names.size();
+   h.numFanout = fanout.size();
+   h.numFanoutInv = fanoutInv.size();
+   for (const CirGate *g : netList)
+      net.push_back(index[g]);
+
+   vector<uint32_t> fecOffset(1, 0);
+   vector<uint32_t> fecMember;
+   for (const vector<unsigned>& grp : fecGroup) {
+      fecMember.insert(fecMember.end(), grp.begin(), grp.end());
+      fecOffset.push_back(fecMember.size());
+   }
+   h.numFecMember = fecMember.size();
+
+   string buf;
+   appendSection(buf, &h, 1);
+   appendSection(buf, gates.data(), gates.size());
+   appendSection(buf, names.data(), names.size());
+   appendSection(buf, fanout.data(), fanout.size());
+   appendSection(buf, fanoutInv.data(), fanoutInv.size());
+   appendSection(buf, net.data(), net.size());
+   appendSection(buf, with_float.data(), with_float.size());
+   appendSection(buf, def_notused.data(), def_notused.size());
+   appendSection(buf, fecOffset.data(), fecOffset.size());
+   appendSection(buf, fecMember.data(), fecMember.size());
+
+   vector<ull> zeroSig(h.sigWords, 0);
+   for (size_t i = 0; i < numGates; ++i) {
+      const ull* v = _simArena? simValue(CirCuit[i]->gateId): zeroSig.data();
+      appendSection(buf, v, h.sigWords);
+   }
+
+   ofstream ofs(fileName.c_str(), ios::out | ios::binary);
+   if (!ofs) {
+      cerr << "Cannot open checkpoint \"" << fileName << "\"!!" << endl;
+      return false;
+   }
+   ofs.write(buf.data(), buf.size());
+   return (bool)ofs;
+}
+
+bool
+CirMgr::readCheckpoint(const string& fileName, int& cmdState)
+{
+   MyMmapFile mf;
+   if (!mf.open(fileName)) {
+      cerr << "Cannot open checkpoint \"" << fileName << "\"!!" << endl;
+      return false;
+   }
+   CkptCursor cur = { mf.begin(), mf.end() };
+   const CkptHeader *h = cur.take<CkptHeader>(1);
+   if (!h || memcmp(h->magic, CkptMagic, sizeof(CkptMagic)) != 0) {
+      cerr << "\"" << fileName << "\" is not a checkpoint file!!" << endl;
+      return false;
+   }
+   if (h->version != CkptVersion) {
+      cerr << "Checkpoint version " << h->version << " is not supported "
+           << "(expecting " << CkptVersion << ")!!" << endl;
+      return false;
+   }
+
+   uint32_t numGates = h->numGates;
+   const CkptGate *gates    = cur.take<CkptGate>(numGates);
+   const char     *names    = cur.take<char>(h->nameBytes);
+   const uint32_t *fanout   = cur.take<uint32_t>(h->numFanout);
+   const uint8_t  *foInv    = cur.take<uint8_t>(h->numFanoutInv);
+   const uint32_t *net      = cur.take<uint32_t>(h->numNet);
+   const int32_t  *flo      = cur.take<int32_t>(h->numFloat);
+   const int32_t  *notUsed  = cur.take<int32_t>(h->numNotUsed);
+   const uint32_t *fecOff   = cur.take<uint32_t>((size_t)h->numFec + 1);
+   const uint32_t *fecMem   = cur.take<uint32_t>(h->numFecMember);
+   const uint64_t *sig      = cur.take<uint64_t>((size_t)numGates * h->sigWords);
+   // a section that does not fit is 0 (an empty one never is)
+   if (!gates || !names || !fanout || !foInv || !net || !flo ||
+       !notUsed || !fecOff || !fecMem || !sig || numGates == 0 ||
+       h->sigWords == 0) {
+      cerr << "Checkpoint \"" << fileName << "\" is truncated!!" << endl;
+      return false;
+   }
+
+   auto corrupted = [&]() {
+      cerr << "Checkpoint \"" << fileName << "\" is corrupted!!" << endl;
+      return false;
+   };
+   uint64_t nameLeft = h->nameBytes, foLeft = h->numFanout,
+            foInvLeft = h->numFanoutInv;
+   for (uint32_t i = 0; i < numGates; ++i) {
+      const CkptGate& r = gates[i];
+      if (r.type >= TOT_GATE || r.numFanin > 2 || r.nameLen > nameLeft ||
+          r.id < 0 || (int64_t)r.id > (int64_t)h->miloa[0] + h->miloa[3] ||
+          r.numFanout > foLeft || r.numFanoutInv > foInvLeft)
+         return corrupted();
+      nameLeft -= r.nameLen;
+      foLeft -= r.numFanout;
+      foInvLeft -= r.numFanoutInv;
+   }
+   if (gates[0].type != CONST_GATE)
+      return corrupted();
+
+   cmdState = h->cmdState;
+   patternNum = h->patternNum;
+   memcpy(MILOA, h->miloa, sizeof(MILOA));
+
+   // gates (CirCuit[0] is the constant created by the constructor)
+   CirCuit.resize(numGates);
+   _gatePool.reserve(numGates - 1);
+   Map.clear();
+   Map.reserve(numGates);
+   for (uint32_t i = 0; i < numGates; ++i) {
+      const CkptGate& r = gates[i];
+      if (i == 0) {
+         CirCuit[0]->line = r.line;
+         CirCuit[0]->column = r.column;
+      }
+      else
+         CirCuit[i] = _gatePool.alloc((GateType)r.type, r.id, r.line,
+                                      r.column);
+      CirCuit[i]->name.assign(names, r.nameLen);
+      names += r.nameLen;
+      Map[r.id] = CirCuit[i];
+   }
+
+   // connections
+   for (uint32_t i = 0; i < numGates; ++i) {
+      const CkptGate& r = gates[i];
+      CirGate *g = CirCuit[i];
+      for (uint32_t j = 0; j < r.numFanin; ++j) {
+         uint32_t lit = r.fanin[j];
+         if (lit == CkptNoFanin || (lit >> 2) >= numGates)
+            return corrupted();
+         g->fanIn.push_back(CirCuit[lit >> 2]);
+         g->fanIn_inv.push_back(lit & 1);
+         g->fanIn_flo.push_back(lit & 2);
+      }
+      g->fanOut.reserve(r.numFanout);
+      for (uint32_t j = 0; j < r.numFanout; ++j, ++fanout) {
+         if (*fanout >= numGates) return corrupted();
+         g->fanOut.push_back(CirCuit[*fanout]);
+      }
+      g->fanOut_inv.reserve(r.numFanoutInv);
+      for (uint32_t j = 0; j < r.numFanoutInv; ++j)
+         g->fanOut_inv.push_back(*foInv++);
+   }
+
+   netList.resize(h->numNet);
+   _aigDirty = true;
+   for (uint32_t i = 0; i < h->numNet; ++i) {
+      if (net[i] >= numGates) return corrupted();
+      netList[i] = CirCuit[net[i]];
+   }
+   with_float.assign(flo, flo + h->numFloat);
+   def_notused.assign(notUsed, notUsed + h->numNotUsed);
+
+   fecGroup.resize(h->numFec);
+   for (uint32_t i = 0; i < h->numFec; ++i) {
+      if (fecOff[i] > fecOff[i + 1] || fecOff[i + 1] > h->numFecMember)
+         return corrupted();
+      fecGroup[i].assign(fecMem + fecOff[i], fecMem + fecOff[i + 1]);
+      for (unsigned lit : fecGroup[i])
+         if (!getGate(lit >> 1)) return corrupted();
+   }
+
+   if (h->simWords < h->sigWords || h->simWords > (1 << 20) / 64)
+      return corrupted();
+   setSimWidth((size_t)h->simWords * 64);
+   initSimArena();
+   _simPiPrev.clear();  // only the signatures are restored
+   for (uint32_t i = 0; i < numGates; ++i, sig += h->sigWords) {
+      ull* v = simValue(CirCuit[i]->gateId);
+      memcpy(v, sig, h->sigWords * sizeof(ull));
+      memset(v + h->sigWords, 0, (_simWords - h->sigWords) * sizeof(ull));
+   }
+   setFecIdx();
+
+   delCirIdHash = new bool[MILOA[0] + MILOA[3] + 1] {false};
+   return true;
+}
@@ -11,11 +11,16 @@
 #include <iomanip>
 #include <algorithm>
 #include <cassert>
-#include <bitset>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <unordered_map>
+#include <chrono>
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "util.h"
 #include "time.h"
+#include "myMmap.h"
 
 using namespace std;
 
@@ -25,194 +30,975 @@ using namespace std;
 /*******************************/
 /*   Global variable and enum  */
 /*******************************/
-bitset<PatternSIZE> zero;
-
-
 
 /**************************************/
 /*   Static varaibles and functions   */
 /**************************************/
+static const int maxExhaustivePI = 24;
+
+// 64-byte aligned, zeroed words; exits if out of memory
+static ull*
+allocSimWords(size_t n)
+{
+  size_t bytes = n * sizeof(ull);
+  void* p = 0;
+  if (posix_memalign(&p, 64, bytes) != 0) {
+    cerr << "Error: Cannot allocate " << bytes << " bytes of simulation "
+         << "values!!" << endl;
+    exit(-1);
+  }
+  memset(p, 0, bytes);
+  return (ull*)p;
+}
+
+static inline ull
+load8(const char* p)
+{
+  ull x;
+  memcpy(&x, p, 8);
+  return x;
+}
+
+// Return the index of the first char in [p, p+n) that is not '0'/'1'
+// (n if there is none); 8 chars are checked at a time.
+static size_t
+checkPattern(const char* p, size_t n)
+{
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    if ((load8(p + i) ^ 0x3030303030303030ULL) & 0xFEFEFEFEFEFEFEFEULL)
+      break;
+  for (; i < n; ++i)
+    if (p[i] != '0' && p[i] != '1') break;
+  return i;
+}
+
+// Find the next whitespace-separated token in [p, end)
+static inline bool
+nextToken(const char*& p, const char* end, const char*& tok, size_t& len)
+{
+  while (p != end && isspace((unsigned char)*p)) ++p;
+  if (p == end) return false;
+  tok = p;
+  while (p != end && !isspace((unsigned char)*p)) ++p;
+  len = p - tok;
+  return true;
+}
+
+// Transpose up to 64 validated patterns (rows of nPI '0'/'1' chars) into
+// one simulation word per PI: pattern k goes to bit k of piWord[i].
+// 8 PIs are handled at a time; 8 patterns are OR-ed into one 64-bit word
+// per 8 rows (byte j = PI j, bit i = row i), then an 8x8 byte transpose
+// yields the 8 PI words.
+static void
+transposePatterns(const char* const* rows, size_t nRows, int nPI,
+                  ull* piWord, size_t stride)
+{
+  char pad[8];
+  for (int c = 0; c < nPI; c += 8) {
+    int nb = nPI - c < 8? nPI - c: 8;
+    ull y[8] = { 0 };
+    for (size_t r = 0; r < nRows; ++r) {
+      ull v;
+      if (nb == 8) v = load8(rows[r] + c);
+      else {
+        memset(pad, '0', 8);
+        memcpy(pad, rows[r] + c, nb);
+        v = load8(pad);
+      }
+      y[r >> 3] |= (v ^ 0x3030303030303030ULL) << (r & 7);
+    }
+    for (int j = 0; j < nb; ++j) {
+      ull w = 0;
+      for (int g = 0; g < 8; ++g)
+        w |= ((y[g] >> (8 * j)) & 0xffULL) << (8 * g);
+      piWord[(size_t)(c + j) * stride] = w;
+    }
+  }
+}
+
+// Validate all whitespace-separated patterns in [p, end) against nPI
+// and return the number of patterns, or -1 after printing an error.
+// If nPI < 0, it is taken from the first pattern.
+static long long
+validatePatterns(const char* p, const char* end, int& nPI)
+{
+  const char* tok = "";
+  size_t len = 0;
+  long long n = 0;
+  bool hasPattern = nextToken(p, end, tok, len);
+  if (nPI < 0) nPI = len;
+  do {
+    size_t col = nPI;
+    size_t bad = checkPattern(tok, len < col? len: col);
+    if (len != col || !hasPattern) {
+      cerr << "Error: Pattern(" << string(tok, len) << ") length(" << len
+           << ") does not match the number of inputs(" << nPI
+           << ") in a circuit!!" << endl;
+      return -1;
+    }
+    if (bad != len) {
+      cerr << "Error: Pattern(" << string(tok, len)
+           << ") contains a non-0/1 character('" << tok[bad] << "')."
+           << endl;
+      return -1;
+    }
+    ++n;
+  } while (nextToken(p, end, tok, len));
+  return n;
+}
+
+// Packed pattern file: PatHeader, then for each PI (in order) the
+// ceil(numPattern/64) words holding its value in every pattern.
+// Pattern k of a PI is bit (k%64) of its word k/64; unused bits are 0.
+static const char  patMagic[8] = { 'F','R','A','I','G','P','A','T' };
+static const unsigned  patVersion = 1;
+
+struct PatHeader
+{
+  char      magic[8];
+  uint32_t  version;
+  uint32_t  numPI;
+  uint64_t  numPattern;
+};
+
+static inline bool
+isPackedPattern(const MyMmapFile& mf)
+{
+  return mf.size() >= sizeof(PatHeader) &&
+         memcmp(mf.begin(), patMagic, sizeof(patMagic)) == 0;
+}
+
+// Simulation log in binary layout (see simOutput())
+static const char  logMagic[8] = { 'F','R','A','I','G','L','O','G' };
+static const unsigned  logVersion = 1;
+
+struct LogHeader
+{
+  char      magic[8];
+  uint32_t  version;
+  uint32_t  numPI;
+  uint32_t  numPO;
+  uint32_t  reserved;
+};
+
+// AND kernel: o = (a ^ ma) & (b ^ mb) over n words, where ma/mb are
+// 0 or ~0 (fanin inverted). The vector versions pick the matching
+// ANDN/NOR form (AVX2) or a single ternary-logic op (AVX-512) instead of
+// complementing the inputs; the ISA is chosen once from CPUID.
+typedef void (*SimAndFn)(ull*, const ull*, ull, const ull*, ull, size_t);
+
+static void
+simAndScalar(ull* o, const ull* a, ull ma, const ull* b, ull mb, size_t n)
+{
+  for (size_t k = 0; k < n; ++k)
+    o[k] = (a[k] ^ ma) & (b[k] ^ mb);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+__attribute__((target("avx2"))) static void
+simAndAvx2(ull* o, const ull* a, ull ma, const ull* b, ull mb, size_t n)
+{
+  size_t k = 0;
+  if (ma && mb) {
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    for (; k + 4 <= n; k += 4) {
+      __m256i va = _mm256_loadu_si256((const __m256i*)(a + k));
+      __m256i vb = _mm256_loadu_si256((const __m256i*)(b + k));
+      _mm256_storeu_si256((__m256i*)(o + k),
+                          _mm256_xor_si256(_mm256_or_si256(va, vb), ones));
+    }
+  }
+  else {
+    // andnot(x, y) = ~x & y
+    const ull *x = mb? b: a, *y = mb? a: b;
+    bool inv = ma || mb;
+    for (; k + 4 <= n; k += 4) {
+      __m256i vx = _mm256_loadu_si256((const __m256i*)(x + k));
+      __m256i vy = _mm256_loadu_si256((const __m256i*)(y + k));
+      _mm256_storeu_si256((__m256i*)(o + k), inv?
+                          _mm256_andnot_si256(vx, vy):
+                          _mm256_and_si256(vx, vy));
+    }
+  }
+  simAndScalar(o + k, a + k, ma, b + k, mb, n - k);
+}
+
+template <int imm>
+__attribute__((target("avx512f"))) static void
+simAndAvx512Imm(ull* o, const ull* a, const ull* b, size_t n, size_t& k)
+{
+  for (; k + 8 <= n; k += 8) {
+    __m512i va = _mm512_loadu_si512((const void*)(a + k));
+    __m512i vb = _mm512_loadu_si512((const void*)(b + k));
+    _mm512_storeu_si512((void*)(o + k),
+                        _mm512_ternarylogic_epi64(va, vb, vb, imm));
+  }
+}
+
+__attribute__((target("avx512f"))) static void
+simAndAvx512(ull* o, const ull* a, ull ma, const ull* b, ull mb, size_t n)
+{
+  // truth table index = (a << 2) | (b << 1) | c, c is a copy of b
+  size_t k = 0;
+  if (!ma && !mb) simAndAvx512Imm<0xC0>(o, a, b, n, k);
+  else if (ma && !mb) simAndAvx512Imm<0x0C>(o, a, b, n, k);
+  else if (!ma && mb) simAndAvx512Imm<0x30>(o, a, b, n, k);
+  else simAndAvx512Imm<0x03>(o, a, b, n, k);
+  simAndScalar(o + k, a + k, ma, b + k, mb, n - k);
+}
+
+static SimAndFn
+pickSimAnd()
+{
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return simAndAvx512;
+  if (__builtin_cpu_supports("avx2")) return simAndAvx2;
+  return simAndScalar;
+}
+#else
+static SimAndFn
+pickSimAnd() { return simAndScalar; }
+#endif
+
+static const SimAndFn simAnd = pickSimAnd();
+
+// Signal statistics of one gate over n words: the number of 1s, and of
+// toggles between consecutive patterns, where "prev" (bit 0) is the
+// pattern before bit 0 of word 0. "last" masks the valid patterns of
+// the last word. Toggles are the 1s of v ^ (v << 1), carrying the top
+// bit of the previous word; the vector versions count 4 (AVX2, nibble
+// lookup) or 8 (AVX-512 VPOPCNTDQ) words at a time.
+typedef void (*SimCountFn)(const ull*, size_t, ull, ull, ull&, ull&);
+
+static inline __attribute__((always_inline)) void
+simCountBody(const ull* v, size_t n, ull last, ull prev, ull& ones,
+             ull& toggles)
+{
+  ull o = 0, t = 0;
+  for (size_t k = 0; k + 1 < n; ++k) {
+    o += __builtin_popcountll(v[k]);
+    t += __builtin_popcountll(v[k] ^ (v[k] << 1 | prev));
+    prev = v[k] >> 63;
+  }
+  o += __builtin_popcountll(v[n - 1] & last);
+  t += __builtin_popcountll((v[n - 1] ^ (v[n - 1] << 1 | prev)) & last);
+  ones += o;
+  toggles += t;
+}
+
+static void
+simCountScalar(const ull* v, size_t n, ull last, ull prev, ull& ones,
+               ull& toggles)
+{
+  simCountBody(v, n, last, prev, ones, toggles);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("popcnt"))) static void
+simCountPopcnt(const ull* v, size_t n, ull last, ull prev, ull& ones,
+               ull& toggles)
+{
+  simCountBody(v, n, last, prev, ones, toggles);
+}
+
+// 4 64-bit popcounts
+__attribute__((target("avx2"))) static inline __m256i
+popcount256(__m256i x)
+{
+  const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3,
+                                       1, 2, 2, 3, 2, 3, 3, 4,
+                                       0, 1, 1, 2, 1, 2, 2, 3,
+                                       1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i nib = _mm256_set1_epi8(0x0f);
+  __m256i lo = _mm256_and_si256(x, nib);
+  __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), nib);
+  __m256i c = _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo),
+                              _mm256_shuffle_epi8(lut, hi));
+  return _mm256_sad_epu8(c, _mm256_setzero_si256());
+}
+
+// Word 0 and the last word (masked) are left to simCountBody()
+__attribute__((target("popcnt,avx2"))) static void
+simCountAvx2(const ull* v, size_t n, ull last, ull prev, ull& ones,
+             ull& toggles)
+{
+  size_t k = 1;
+  __m256i o = _mm256_setzero_si256(), t = o;
+  for (; k + 4 < n; k += 4) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)(v + k));
+    __m256i p = _mm256_loadu_si256((const __m256i*)(v + k - 1));
+    __m256i y = _mm256_or_si256(_mm256_slli_epi64(x, 1),
+                                _mm256_srli_epi64(p, 63));
+    o = _mm256_add_epi64(o, popcount256(x));
+    t = _mm256_add_epi64(t, popcount256(_mm256_xor_si256(x, y)));
+  }
+  if (k == 1) {
+    simCountBody(v, n, last, prev, ones, toggles);
+    return;
+  }
+  ull so[4], st[4];
+  _mm256_storeu_si256((__m256i*)so, o);
+  _mm256_storeu_si256((__m256i*)st, t);
+  simCountBody(v, 1, ~0ULL, prev, ones, toggles);
+  ones += so[0] + so[1] + so[2] + so[3];
+  toggles += st[0] + st[1] + st[2] + st[3];
+  simCountBody(v + k, n - k, last, v[k - 1] >> 63, ones, toggles);
+}
+
+__attribute__((target("popcnt,avx512f,avx512vpopcntdq"))) static void
+simCountAvx512(const ull* v, size_t n, ull last, ull prev, ull& ones,
+               ull& toggles)
+{
+  size_t k = 1;
+  __m512i o = _mm512_setzero_si512(), t = o;
+  for (; k + 8 < n; k += 8) {
+    __m512i x = _mm512_loadu_si512((const void*)(v + k));
+    __m512i p = _mm512_loadu_si512((const void*)(v + k - 1));
+    __m512i y = _mm512_or_si512(_mm512_slli_epi64(x, 1),
+                                _mm512_srli_epi64(p, 63));
+    o = _mm512_add_epi64(o, _mm512_popcnt_epi64(x));
+    t = _mm512_add_epi64(t, _mm512_popcnt_epi64(_mm512_xor_si512(x, y)));
+  }
+  if (k == 1) {
+    simCountBody(v, n, last, prev, ones, toggles);
+    return;
+  }
+  simCountBody(v, 1, ~0ULL, prev, ones, toggles);
+  ones += _mm512_reduce_add_epi64(o);
+  toggles += _mm512_reduce_add_epi64(t);
+  simCountBody(v + k, n - k, last, v[k - 1] >> 63, ones, toggles);
+}
+
+static SimCountFn
+pickSimCount()
+{
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512vpopcntdq")) return simCountAvx512;
+  if (__builtin_cpu_supports("avx2")) return simCountAvx2;
+  if (__builtin_cpu_supports("popcnt")) return simCountPopcnt;
+  return simCountScalar;
+}
+#else
+static SimCountFn
+pickSimCount() { return simCountScalar; }
+#endif
+
+static const SimCountFn simCount = pickSimCount();
+
+// Count a slice of n words into st[0] (1s) and st[1] (toggles within
+// the slice); st[2] gets the first (bit 0) and last (bit 1) pattern value
+static inline void
+simCountSlice(const ull* v, size_t n, ull* st)
+{
+  st[0] = st[1] = 0;
+  simCount(v, n, ~0ULL, v[0] & 1, st[0], st[1]);
+  st[2] = (v[0] & 1) | (v[n - 1] >> 63 << 1);
+}
 
 void
 CirMgr::simulate() {
-  
-  unordered_map<bitset<PatternSIZE>, vector<int> > tmpMap;
-  unordered_map<bitset<PatternSIZE>, vector<int> >::iterator it;
+  const size_t W = _simWords;
 
   // update value
-  for (CirGate* cur : netList) {
-    if (!cur->isAig()) continue;
-    bitset<PatternSIZE> bs[2];
-    for (int i = 0; i < 2; ++i) {
-      if (cur->fanIn[i]->gateType == UNDEF_GATE) {
-        if (cur->fanIn_inv[0]) {
-          bs[i] = ~zero;
-        } else {
-          bs[i] = zero; }
-      } else {
-        if (cur->fanIn_inv[i]) {
-          bs[i] = ~cur->fanIn[i]->gateValue;
-        } else {
-          bs[i] = cur->fanIn[i]->gateValue; } }
+  const size_t nPI = MILOA[1];
+  if (_simX) {
+    ull* z = simZero(0);
+    for (size_t k = 0; k < W; ++k) z[k] = ~0ULL;
+    for (size_t i = 0; i < nPI; ++i) {
+      unsigned gid = CirCuit[i + 1]->gateId;
+      const ull* v = simValue(gid);
+      z = simZero(gid);
+      for (size_t k = 0; k < W; ++k) z[k] = ~v[k];
     }
-    cur->gateValue = (bitset<PatternSIZE>)(bs[0] & bs [1]);
-
   }
+  if (_simIncremental) {
+    size_t total = _simConeOn? _simConeOrder.size() + _simConePO.size():
+                               _aigOrder.size() + MILOA[3];
+    size_t n = total;
+    if (simPrevValid()) n = simulateEvents();
+    else simulateWords(0, W);
+    cout << "Batch " << patternNum / (W * 64) + 1 << ": " << n << " of "
+         << total << " gates re-evaluated." << endl;
+  }
+  else simulateAll();
+  _simPiPrev.resize(nPI * W);
+  _simPrevCone = _simConeOn;
+  _simPrevWords = W;
+  _simPrevX = _simX;
+  for (size_t i = 0; i < nPI; ++i)
+    memcpy(&_simPiPrev[i * W], simValue(CirCuit[i + 1]->gateId),
+           W * sizeof(ull));
 
-  fecGroupBetter();
-  int preSize = fecGroup.size();
-  if (preSize == 0) {
-    tmpMap[zero].push_back(0);
-    for (CirGate* cur : netList) {
-      if (cur->isAig()) {
-        // hash into tmpMap
-        it = tmpMap.find(cur->gateValue);
-        if (it != tmpMap.end()) {
-          it->second.push_back(cur->gateId);
-          continue;
+  // gates with an X in any pattern are no FEC candidates
+  if (_simX) {
+    for (unsigned gid : _simConeOn? _simConeOrder: _aigOrder) {
+      if (_simXGone[gid]) continue;
+      const ull *v = simValue(gid), *z = simZero(gid);
+      for (size_t k = 0; k < W && !_simXGone[gid]; ++k)
+        if (~(v[k] | z[k])) {
+          _simXGone[gid] = true;
+          ++_simXNum;
         }
-        it = tmpMap.find(~cur->gateValue);
-        if (it != tmpMap.end()) {
-          it->second.push_back(cur->gateId + e10);
-          continue;
-        }
-        tmpMap[cur->gateValue].push_back(cur->gateId);
-      }
     }
+    fecRemove(_simXGone);
+  }
+  fecRefine();
+  // the cone of the FEC candidates shrinks with them
+  if (_simConeOn && _simConeFec) {
+    size_t m = 0;
+    for (const FecClass& c : _fecClass) m += c.second;
+    if (2 * m <= _simConeMembers) buildSimCone();
+  }
+}
 
-    // push into fecGroup
-    for (it = tmpMap.begin(); it != tmpMap.end(); ++it) {
-      int tmpSize = it->second.size();
-      if (tmpSize < 2) continue;
-      fecGroup.push_back(it->second);
-    }
+// Evaluate all the gates on the current PI values
+void
+CirMgr::simulateAll()
+{
+  const size_t W = _simWords, nThreads = _simPool.size();
+  if (_simLevelized && nThreads > 1 && !_simX) {
+    simulateLevels();
+    return;
   }
-  else {
-    for (int i = 0; i < preSize; ++i) {
-      int gSize = fecGroup[i].size();
-      if (gSize < 2) continue;
-
-      vector<int> invGpIdx;
-      tmpMap.clear();
-      for (int j = 0; j < gSize; ++j) {
-        int curId = fecGroup[i][j];
-        if (curId < e10) {
-          bitset<PatternSIZE> tmpValue = Map[curId]->gateValue;
-          it = tmpMap.find(tmpValue);
-          if (it != tmpMap.end()) {
-            it->second.push_back(curId);
-            continue;
-          }
-          tmpMap[tmpValue].push_back(curId);        
-        }
-      }
-      for (int j = 0; j < gSize; ++j) {
-        int curId = fecGroup[i][j];
-        if (curId >= e10) {
-          bitset<PatternSIZE> tmpValue = Map[curId - e10]->gateValue;
-          it = tmpMap.find(~tmpValue);
-          if (it != tmpMap.end()) {
-            it->second.push_back(curId);
-            continue;
-          }
-          else {
-            invGpIdx.push_back(j);
-          }
-        }
-      }
-      // push into fecGroup
-      for (it = tmpMap.begin(); it != tmpMap.end(); ++it) {
-        int tmpSize = it->second.size();
-        if (tmpSize < 2) continue;
-        fecGroup.push_back(it->second);
-      }
+  // each thread takes a slice of the pattern words (a multiple of 8
+  // words, i.e. cache lines, where possible)
+  size_t slice = (W + nThreads - 1) / nThreads;
+  if (W >= 8 * nThreads) slice = (slice + 7) & ~(size_t)7;
+  // signal statistics are counted while the values are in cache
+  _statSlice = _statOn? slice: 0;
+  _simPool.run([&](size_t t) {
+    size_t k0 = t * slice;
+    if (k0 < W) simulateWords(k0, k0 + slice < W? k0 + slice: W,
+                              _statSlice? _statPart[t].data(): 0);
+  });
+}
 
-      tmpMap.clear();
-      for (int kId : invGpIdx) {
-        int curId = fecGroup[i][kId] - e10;
-        bitset<PatternSIZE> tmpValue = Map[curId]->gateValue;
-        it = tmpMap.find(tmpValue);
-        if (it != tmpMap.end()) {
-          it->second.push_back(curId);
-          continue;
-        }
-        it = tmpMap.find(~tmpValue);
-        if (it != tmpMap.end()) {
-          it->second.push_back(curId + e10);
-          continue;
-        }
-        tmpMap[tmpValue].push_back(curId);
+// Evaluate the AIG level by level; the gates of a level are split into
+// one chunk per thread, with a barrier before the next level
+void
+CirMgr::simulateLevels()
+{
+  const unsigned* fanin = _aigFanin.data();
+  const size_t W = _simWords, T = _simPool.size();
+  const vector<unsigned>& order = _simConeOn? _simConeLevelOrder:
+                                              _aigLevelOrder;
+  const vector<unsigned>& offset = _simConeOn? _simConeLevelOffset:
+                                               _aigLevelOffset;
+  const size_t nLevel = offset.size() - 1;
+  MyBarrier barrier(T);
+  _simPool.run([&](size_t t) {
+    for (size_t l = 0; l < nLevel; ++l) {
+      size_t b = offset[l], n = offset[l + 1] - b;
+      for (size_t i = b + n * t / T, e = b + n * (t + 1) / T; i < e; ++i) {
+        unsigned gid = order[i];
+        unsigned la = fanin[2 * gid], lb = fanin[2 * gid + 1];
+        simAnd(simValue(gid), simValue(la >> 1), -(ull)(la & 1),
+               simValue(lb >> 1), -(ull)(lb & 1), W);
       }
-      // push into fecGroup
-      for (it = tmpMap.begin(); it != tmpMap.end(); ++it) {
-        int tmpSize = it->second.size();
-        if (tmpSize < 2) continue;
-        fecGroup.push_back(it->second);
+      barrier.wait();
+    }
+    size_t nPO = _simConeOn? _simConePO.size(): MILOA[3];
+    for (size_t i = nPO * t / T, e = nPO * (t + 1) / T; i < e; ++i)
+      simulatePO(_simConeOn? _simConePO[i]: MILOA[0] + 1 + i, 0, W);
+  });
+}
+
+// The last batch is a baseline for simulateEvents() only if the gates
+// to be simulated all hold its values: they were evaluated from its PI
+// words (_simPiPrev is cleared whenever the arena or the netlist is
+// changed otherwise), at the same width and in the same mode
+bool
+CirMgr::simPrevValid() const
+{
+  return _simPiPrev.size() == (size_t)MILOA[1] * _simWords &&
+         _simPrevWords == _simWords && _simPrevX == _simX &&
+         (!_simPrevCone || _simConeOn);
+}
+
+// Event-driven resimulation against the previous batch: only the gates in
+// the transitive fanout of the PIs whose words changed are re-evaluated,
+// level by level from _simEvQueue, and only over the range of words that
+// changed. A gate whose value stays the same schedules no fanouts.
+// Returns the number of AIGs and POs re-evaluated.
+size_t
+CirMgr::simulateEvents()
+{
+  const unsigned* fanin = _aigFanin.data();
+  const size_t W = _simWords;
+  size_t k0 = W, k1 = 0;
+  vector<unsigned> seeds, poQueue;
+  for (int i = 0; i < MILOA[1]; ++i) {
+    unsigned gid = CirCuit[i + 1]->gateId;
+    const ull *v = simValue(gid), *old = &_simPiPrev[i * W];
+    size_t b = 0, e = W;
+    while (b < W && v[b] == old[b]) ++b;
+    if (b == W) continue;
+    while (v[e - 1] == old[e - 1]) --e;
+    if (b < k0) k0 = b;
+    if (e > k1) k1 = e;
+    seeds.push_back(gid);
+  }
+  if (seeds.empty()) return 0;
+
+  const size_t n = k1 - k0, nLevel = _aigLevelOffset.size();
+  _simEvQueue.resize(nLevel);
+  _simEvMark.assign(_aigType.size(), 0);
+  auto schedule = [&](unsigned gid) {
+    for (unsigned j = _aigFoOffset[gid]; j < _aigFoOffset[gid + 1]; ++j) {
+      unsigned fo = _aigFanout[j] >> 1;
+      if (_simEvMark[fo] || (_simConeOn && !_simConeMark[fo])) continue;
+      if (_aigType[fo] == PO_GATE) poQueue.push_back(fo);
+      else if (_aigLevel[fo]) _simEvQueue[_aigLevel[fo]].push_back(fo);
+      else continue;  // not in netList, never simulated
+      _simEvMark[fo] = 1;
+    }
+  };
+  for (unsigned gid : seeds) schedule(gid);
+
+  size_t count = 0;
+  ull* tmp = _simScratch;
+  for (size_t l = 1; l < nLevel; ++l) {
+    for (size_t i = 0; i < _simEvQueue[l].size(); ++i) {
+      unsigned gid = _simEvQueue[l][i];
+      unsigned la = fanin[2 * gid], lb = fanin[2 * gid + 1];
+      simAnd(tmp, simValue(la >> 1) + k0, -(ull)(la & 1),
+             simValue(lb >> 1) + k0, -(ull)(lb & 1), n);
+      ull* v = simValue(gid) + k0;
+      if (memcmp(tmp, v, n * sizeof(ull)) != 0) {
+        memcpy(v, tmp, n * sizeof(ull));
+        schedule(gid);
       }
+    }
+    count += _simEvQueue[l].size();
+    _simEvQueue[l].clear();
+  }
+  for (unsigned gid : poQueue)
+    simulatePO(gid, k0, k1);
+  return count + poQueue.size();
+}
+
+// Evaluate the AIG gates and POs on pattern words [k0, k1);
+// UNDEF and CONST gates keep their all-0 value
+void
+CirMgr::simulateWords(size_t k0, size_t k1, ull* stat)
+{
+  if (_simX) {
+    simulateWordsX(k0, k1);
+    return;
+  }
+  const unsigned* fanin = _aigFanin.data();
+  size_t n = k1 - k0;
+  for (unsigned gid : _simConeOn? _simConeOrder: _aigOrder) {
+    unsigned la = fanin[2 * gid], lb = fanin[2 * gid + 1];
+    ull* v = simValue(gid) + k0;
+    simAnd(v, simValue(la >> 1) + k0, -(ull)(la & 1),
+           simValue(lb >> 1) + k0, -(ull)(lb & 1), n);
+    if (stat) simCountSlice(v, n, stat + 3 * gid);
+  }
+  for (size_t i = 0, m = _simConeOn? _simConePO.size(): MILOA[3]; i < m;
+       ++i) {
+    unsigned gid = _simConeOn? _simConePO[i]: MILOA[0] + 1 + i;
+    simulatePO(gid, k0, k1);
+    ull* v = simValue(gid) + k0;
+    if (stat) simCountSlice(v, n, stat + 3 * gid);
+  }
+}
 
-      fecGroup[i].clear();
+// Three-valued simulation (-Xvalue): each value is kept in two planes,
+// simValue() (bit set: 1) and simZero() (bit set: 0); a bit clear in
+// both is X. UNDEF gates are X in every pattern. An inversion swaps the
+// planes; an AND is 1 if both fanins are 1 and 0 if either is 0.
+void
+CirMgr::simulateWordsX(size_t k0, size_t k1)
+{
+  auto fanin = [&](unsigned lit, const ull*& one, const ull*& zero) {
+    one = simValue(lit >> 1);
+    zero = simZero(lit >> 1);
+    if (lit & 1) swap(one, zero);
+  };
+  const ull *a1, *a0, *b1, *b0;
+  for (unsigned gid : _simConeOn? _simConeOrder: _aigOrder) {
+    fanin(_aigFanin[2 * gid], a1, a0);
+    fanin(_aigFanin[2 * gid + 1], b1, b0);
+    ull *o1 = simValue(gid), *o0 = simZero(gid);
+    for (size_t k = k0; k < k1; ++k) {
+      o1[k] = a1[k] & b1[k];
+      o0[k] = a0[k] | b0[k];
     }
   }
+  for (size_t i = 0, n = _simConeOn? _simConePO.size(): MILOA[3]; i < n;
+       ++i) {
+    unsigned gid = _simConeOn? _simConePO[i]: MILOA[0] + 1 + i;
+    fanin(_aigFanin[2 * gid], a1, a0);
+    ull *o1 = simValue(gid), *o0 = simZero(gid);
+    for (size_t k = k0; k < k1; ++k) {
+      o1[k] = a1[k];
+      o0[k] = a0[k];
+    }
+  }
+}
+
+void
+CirMgr::simulatePO(unsigned gid, size_t k0, size_t k1)
+{
+  assert(_aigType[gid] == PO_GATE);
+  unsigned la = _aigFanin[2 * gid];
+  const ull* a = simValue(la >> 1);
+  ull ma = -(ull)(la & 1);
+  ull* o = simValue(gid);
+  for (size_t k = k0; k < k1; ++k)
+    o[k] = a[k] ^ ma;
+}
 
-  int PoEnd = MILOA[1] + MILOA[3];
-  for (int i = MILOA[1] + 1; i <= PoEnd; ++i) {
-    assert(CirCuit[i]->gateType == PO_GATE);
-    if (CirCuit[i]->fanIn_inv[0])
-      CirCuit[i]->gateValue = ~CirCuit[i]->fanIn[0]->gateValue;
-    else
-      CirCuit[i]->gateValue = CirCuit[i]->fanIn[0]->gateValue;
+// Restrict the simulation to the transitive fanin of the -Cone gates, or
+// of the current FEC candidates (then rebuilt by simulate() whenever the
+// candidates have halved). The schedule is the matching subsequence of
+// _aigOrder, of _aigLevelOrder level by level, and of the POs; the
+// other gates keep stale values, which are never read.
+void
+CirMgr::buildSimCone()
+{
+  _simConeMark.assign(_aigType.size(), 0);
+  vector<unsigned> stack;
+  if (_simConeFec) {
+    _simConeMembers = 0;
+    for (const FecClass& c : _fecClass) {
+      for (unsigned i = 0; i < c.second; ++i)
+        stack.push_back(_fecLit[c.first + i] >> 1);
+      _simConeMembers += c.second;
+    }
+  }
+  else stack = _simConeRoot;
+  _simConeMark[0] = 1;
+  while (!stack.empty()) {
+    unsigned gid = stack.back();
+    stack.pop_back();
+    if (_simConeMark[gid]) continue;
+    _simConeMark[gid] = 1;
+    if (_aigType[gid] == AIG_GATE)
+      stack.push_back(_aigFanin[2 * gid + 1] >> 1);
+    if (_aigType[gid] == AIG_GATE || _aigType[gid] == PO_GATE)
+      stack.push_back(_aigFanin[2 * gid] >> 1);
+  }
+
+  _simConeOrder.clear();
+  for (unsigned gid : _aigOrder)
+    if (_simConeMark[gid]) _simConeOrder.push_back(gid);
+  _simConeLevelOrder.clear();
+  _simConeLevelOffset.assign(1, 0);
+  for (size_t l = 0; l + 1 < _aigLevelOffset.size(); ++l) {
+    for (size_t i = _aigLevelOffset[l]; i < _aigLevelOffset[l + 1]; ++i)
+      if (_simConeMark[_aigLevelOrder[i]])
+        _simConeLevelOrder.push_back(_aigLevelOrder[i]);
+    _simConeLevelOffset.push_back(_simConeLevelOrder.size());
+  }
+  _simConePO.clear();
+  for (int gid = MILOA[0] + 1; gid <= MILOA[0] + MILOA[3]; ++gid)
+    if (_simConeMark[gid]) _simConePO.push_back(gid);
+
+  cout << "Cone: " << _simConeOrder.size() << " of " << _aigOrder.size()
+       << " AIGs, " << _simConePO.size() << " of " << MILOA[3]
+       << " POs simulated." << endl;
+}
+
+// The number of PIs that the next command will simulate, found before
+// simBegin(): the PIs in the fanin of the -Cone gates, or of the FEC
+// candidates as fecInit() will take them from fecGroup.
+int
+CirMgr::simConePINum()
+{
+  if (!_simConeOn) return MILOA[1];
+  syncAig();
+  vector<unsigned> stack;
+  if (!_simConeFec) stack = _simConeRoot;
+  else if (fecGroup.empty()) stack = _aigOrder;
+  else for (const vector<unsigned>& grp : fecGroup) {
+    size_t first = stack.size();
+    for (unsigned lit : grp) {
+      unsigned gid = lit >> 1;
+      if (gid < _aigType.size() &&
+          (_aigType[gid] == AIG_GATE || _aigType[gid] == CONST_GATE))
+        stack.push_back(gid);
+    }
+    if (stack.size() - first < 2) stack.resize(first);
   }
-  
+  vector<unsigned char> mark(_aigType.size(), 0);
+  int n = 0;
+  while (!stack.empty()) {
+    unsigned gid = stack.back();
+    stack.pop_back();
+    if (mark[gid]) continue;
+    mark[gid] = 1;
+    if (_aigType[gid] == PI_GATE) ++n;
+    if (_aigType[gid] == AIG_GATE)
+      stack.push_back(_aigFanin[2 * gid + 1] >> 1);
+    if (_aigType[gid] == AIG_GATE || _aigType[gid] == PO_GATE)
+      stack.push_back(_aigFanin[2 * gid] >> 1);
+  }
+  return n;
+}
+
+// Common start of a simulation command
+void
+CirMgr::simBegin()
+{
+  initSimArena();
+  syncAig();
+  // the gates outside of the last command's cone are stale, so its
+  // batches are no baseline for -Incremental
+  if (_simPrevCone) _simPiPrev.clear();
+  if (_simConeOn && !_simConeFec) buildSimCone();
+  fecInit();
+  if (_simConeOn && _simConeFec) buildSimCone();
+  if (_faultOn) faultBegin();
+  if (_statOn) statBegin();
+  if (_simX) _simXGone.assign(_aigType.size(), false);
+  _simXNum = 0;
+  patternNum = 0;
 }
 
+// Log, fault-simulate and count the first n patterns of a batch
 void
-CirMgr::simOutput(string fiStr[]) {
-  int n = patternNum % PatternSIZE;
-  string foStr[MILOA[3]];
-  for (int i = 0; i < MILOA[3]; ++i) {
-    if (n == 0)
-      foStr[i] = CirCuit[MILOA[1] + 1 + i]->gateValue.to_string();
-    else
-      foStr[i] = CirCuit[MILOA[1] + 1 + i]->gateValue.to_string().substr(PatternSIZE - n, n);
+CirMgr::simBatchDone(int n)
+{
+  if (_simLog)
+    simOutput(n);
+  if (_faultOn)
+    faultSimulate(n);
+  if (_statOn)
+    statUpdate(n);
+  patternNum += n;
+}
+
+// Common end of a simulation command; "exact" if every input pattern
+// has been simulated
+void
+CirMgr::simEnd(bool exact)
+{
+  if (_simLog)
+    simOutputDone();
+  if (_faultOn)
+    faultReport();
+  if (_statOn)
+    statReport();
+  if (_simX)
+    cout << "X: " << _simXNum << " gates with unknown values are excluded "
+         << "from FEC." << endl;
+  fecExport(exact);
+}
+
+// Log the first n patterns of the current batch (pattern k is bit k).
+// A whole batch is formatted into _simLogBuf straight from the PI/PO
+// words and written at once.
+// Text layout: one "<PI values> <PO values>" line per pattern.
+// Binary layout: LogHeader once, then per batch the pattern count
+// (uint64_t) followed by ceil(n/64) words for each PI, then each PO.
+// If a reference (text) log is set, only the patterns whose PO values
+// differ from it are logged (in text layout).
+void
+CirMgr::simOutput(int n) {
+  int nPI = MILOA[1], nPO = MILOA[3];
+  size_t nw = (n + 63) / 64;
+  vector<const ull*> piW(nPI), poW(nPO), poZ(nPO, (const ull*)0);
+  for (int i = 0; i < nPI; ++i)
+    piW[i] = simValue(CirCuit[i + 1]->gateId);
+  for (int i = 0; i < nPO; ++i) {
+    poW[i] = simValue(CirCuit[nPI + i + 1]->gateId);
+    if (_simX) poZ[i] = simZero(CirCuit[nPI + i + 1]->gateId);
   }
 
-  for (int i = 0; i < n; ++i) {
-    for (int j = 0; j < MILOA[1]; ++j)
-      *_simLog << fiStr[j][i];
-    *_simLog << ' ';
-    for (int j = 0; j < MILOA[3]; ++j)
-      *_simLog << foStr[j][i];
-    *_simLog << endl;
+  _simLogBuf.clear();
+  if (_simLogBinary) {
+    if (_simLog->tellp() == 0) {
+      LogHeader h;
+      memcpy(h.magic, logMagic, sizeof(logMagic));
+      h.version = logVersion;
+      h.numPI = nPI;
+      h.numPO = nPO;
+      h.reserved = 0;
+      _simLogBuf.append((const char*)&h, sizeof(h));
+    }
+    uint64_t cnt = n;
+    _simLogBuf.append((const char*)&cnt, sizeof(cnt));
+    ull last = n % 64? (1ULL << (n % 64)) - 1: ~0ULL;
+    for (int i = 0; i < nPI + nPO; ++i) {
+      const ull* v = i < nPI? piW[i]: poW[i - nPI];
+      _simLogBuf.append((const char*)v, (nw - 1) * sizeof(ull));
+      ull w = v[nw - 1] & last;
+      _simLogBuf.append((const char*)&w, sizeof(w));
+    }
+  }
+  else {
+    size_t lineLen = nPI + nPO + 2;
+    _simLogBuf.resize((size_t)n * lineLen);
+    char* line = &_simLogBuf[0];
+    for (int k = 0; k < n; ++k) {
+      size_t w = k >> 6;
+      int b = k & 63;
+      char* c = line;
+      for (int i = 0; i < nPI; ++i)
+        *c++ = '0' + ((piW[i][w] >> b) & 1);
+      *c++ = ' ';
+      for (int i = 0; i < nPO; ++i)
+        *c++ = (poW[i][w] >> b) & 1? '1':
+               poZ[i] && !((poZ[i][w] >> b) & 1)? 'X': '0';
+      *c++ = '\n';
+      if (_simLogRef.isOpen()) {
+        const char *tok, *end = _simLogRef.end();
+        size_t len;
+        bool same = nextToken(_simLogRefPos, end, tok, len) &&
+                    nextToken(_simLogRefPos, end, tok, len) &&
+                    len == (size_t)nPO &&
+                    memcmp(tok, line + nPI + 1, nPO) == 0;
+        if (same) continue;
+        ++_simLogDiffNum;
+      }
+      line = c;
+    }
+    _simLogBuf.resize(line - &_simLogBuf[0]);
   }
+  _simLog->write(_simLogBuf.data(), _simLogBuf.size());
 }
 
 void
-CirMgr::fecGroupBetter() {
-  int fecSize = fecGroup.size();
-  vector<int> delGroup;
-  for (int i = 0; i < fecSize; ++i) {
-    if (fecGroup[i].size() < 2) {
-      delGroup.push_back(i);
-      fecGroup[i].clear();
+CirMgr::simOutputDone() {
+  _simLog->flush();
+  if (_simLogRef.isOpen()) {
+    cout << _simLogDiffNum << " of " << patternNum << " patterns differ "
+         << "from the reference log." << endl;
+    _simLogRef.close();
+  }
+}
+
+// Per-gate signal statistics (-STats) of PIs, AIGs in netList and POs,
+// accumulated batch by batch: the number of patterns where the gate is
+// 1 (signal probability) and of changes between consecutive patterns
+// (toggle rate); the last value of each batch carries into the next.
+// simulateAll() counts the AIGs and POs right after evaluating them,
+// per thread over its slice of words (_statPart, 3 counts per gateId,
+// see simCountSlice()); the toggles across slices and batches are added
+// here from the slices' first and last values, so that no simulation
+// value is read again. Partial batches and the other simulation kernels
+// are counted in a separate pass.
+void
+CirMgr::statBegin()
+{
+  _statPart.resize(_simPool.size());
+  for (vector<ull>& part : _statPart)
+    part.assign(3 * _aigType.size(), 0);
+  _statSlice = 0;
+  _statGate.clear();
+  for (int i = 1; i <= MILOA[1]; ++i)
+    _statGate.push_back(CirCuit[i]->gateId);
+  _statGate.insert(_statGate.end(), _aigOrder.begin(), _aigOrder.end());
+  for (int gid = MILOA[0] + 1; gid <= MILOA[0] + MILOA[3]; ++gid)
+    _statGate.push_back(gid);
+  _statOnes.assign(_statGate.size(), 0);
+  _statToggles.assign(_statGate.size(), 0);
+  _statLast.assign(_statGate.size(), 0);
+  _statPatterns = 0;
+}
+
+void
+CirMgr::statUpdate(int n)
+{
+  if (n <= 0) return;
+  const size_t nw = (n + 63) / 64, N = _statGate.size(), T = _simPool.size();
+  const ull last = n % 64? (1ULL << (n % 64)) - 1: ~0ULL;
+  const bool first = _statPatterns == 0;
+  const size_t W = _simWords, slice = _statSlice;
+  const bool fused = slice && (size_t)n == W * 64;
+  _simPool.run([&](size_t t) {
+    for (size_t i = N * t / T, e = N * (t + 1) / T; i < e; ++i) {
+      unsigned gid = _statGate[i];
+      if (!fused || _aigType[gid] == PI_GATE) {
+        const ull* v = simValue(gid);
+        // no toggle into the very first pattern
+        simCount(v, nw, last, first? v[0] & 1: _statLast[i], _statOnes[i],
+                 _statToggles[i]);
+        _statLast[i] = (v[(n - 1) / 64] >> ((n - 1) % 64)) & 1;
+        continue;
+      }
+      ull prev = first? _statPart[0][3 * gid + 2] & 1: _statLast[i];
+      for (size_t j = 0; j * slice < W; ++j) {
+        const ull* st = &_statPart[j][3 * gid];
+        _statOnes[i] += st[0];
+        _statToggles[i] += st[1] + ((st[2] ^ prev) & 1);
+        prev = st[2] >> 1;
+      }
+      _statLast[i] = prev;
     }
+  });
+  _statSlice = 0;
+  _statPatterns += n;
+}
+
+// Print the gates with the most biased signal probability, and write all
+// the counts to _statFile (if any) in gateId order:
+//    # <numPatterns>
+//    <gateId> <type> <ones> <toggles>
+void
+CirMgr::statReport() const
+{
+  const size_t N = _statGate.size();
+  if (N == 0 || _statPatterns == 0) return;
+  const double P = _statPatterns, P1 = _statPatterns > 1? P - 1: 1;
+  double sumP = 0, sumT = 0;
+  for (size_t i = 0; i < N; ++i) {
+    sumP += _statOnes[i] / P;
+    sumT += _statToggles[i] / P1;
   }
-  int delSize = delGroup.size();
-  for (int i = delSize-1; i > -1; --i) {
-    swap(fecGroup[--fecSize], fecGroup[delGroup[i]]);
-    fecGroup.pop_back();
+  vector<size_t> idx(N);
+  for (size_t i = 0; i < N; ++i) idx[i] = i;
+  auto bias = [&](size_t i) {
+    double p = _statOnes[i] / P;
+    return p < 0.5? 0.5 - p: p - 0.5;
+  };
+  size_t nShow = N < 20? N: 20;
+  partial_sort(idx.begin(), idx.begin() + nShow, idx.end(),
+               [&](size_t a, size_t b) {
+                 double ba = bias(a), bb = bias(b);
+                 return ba != bb? ba > bb: _statGate[a] < _statGate[b];
+               });
+
+  cout << "Stats: " << _statPatterns << " patterns, " << N << " gates; "
+       << "average P(1) " << fixed << setprecision(4) << sumP / N
+       << ", average toggle rate " << sumT / N << "." << endl;
+  cout << "Most biased gates:" << endl
+       << setw(10) << right << "Gate" << setw(6) << "Type"
+       << setw(10) << "P(1)" << setw(10) << "Toggle" << endl;
+  for (size_t j = 0; j < nShow; ++j) {
+    size_t i = idx[j];
+    cout << setw(10) << _statGate[i] << setw(6)
+         << Map.at(_statGate[i])->getTypeStr()
+         << setw(10) << _statOnes[i] / P << setw(10)
+         << _statToggles[i] / P1 << endl;
   }
+  cout.unsetf(ios::floatfield | ios::adjustfield);
+  cout << setprecision(6);
+
+  if (_statFile.empty()) return;
+  ofstream ofs(_statFile.c_str());
+  if (!ofs) {
+    cerr << "Error: Cannot open \"" << _statFile << "\"!!" << endl;
+    return;
+  }
+  vector<size_t> byId(idx);
+  sort(byId.begin(), byId.end(), [&](size_t a, size_t b) {
+    return _statGate[a] < _statGate[b];
+  });
+  ofs << "# " << _statPatterns << "\n";
+  for (size_t i : byId)
+    ofs << _statGate[i] << " " << Map.at(_statGate[i])->getTypeStr() << " "
+        << _statOnes[i] << " " << _statToggles[i] << "\n";
 }
 
 void
 CirMgr::fecGroupSort_ReId() {
   int fecSize = fecGroup.size();
-  for (int i = 0; i < fecSize; ++i) {
-    int gSize = fecGroup[i].size();
-    for (int j = 0; j < gSize; ++j)
-      if (fecGroup[i][j] >= e10)
-        fecGroup[i][j] -= e10;
-  }
-
   for (int i =0; i < fecSize; ++i) {
     sort(fecGroup[i].begin(), fecGroup[i].end());
   }
@@ -225,7 +1011,7 @@ CirMgr::setFecIdx() {
   for (int i = 0; i < fecSize; ++i) {
     int gSize = fecGroup[i].size();
     for (int j = 0; j < gSize; ++j) {
-      Map[fecGroup[i][j]]->fecIdx = i;
+      Map[fecGroup[i][j] >> 1]->fecIdx = i;
     }
   }
 }
@@ -236,99 +1022,320 @@ CirMgr::setFecIdx() {
 void
 CirMgr::randomSim()
 {
-  srand(time(NULL));
-  int col = MILOA[1]; // row = PatternSIZE
-  patternNum = 0;
-  zero.reset();
-  string fi[col]; // try directlty stored in bitset
+  RandomWordGen rng(_simSeed);
+  int col = MILOA[1];
+  int width = _simWords * 64;
+  simBegin();
   int repeatT;
   if (col < 1000)
-    repeatT = 1 + ((int)(col*col*0.381924) / PatternSIZE);
+    repeatT = 1 + ((int)(col*col*0.381924) / width);
   else
-    repeatT = (40000 / PatternSIZE);
+    repeatT = 1 + (40000 / width);
 
-  for (int t = 0; t < repeatT; ++t) {
-    for (int i = 0; i < col; ++i) {
-      for (int j = 0; j < PatternSIZE / 32; ++j) {
-        bitset<32> tmp(rand());
-        fi[i] += tmp.to_string();
+  // adaptive mode: refinement is measured by the number of FEC groups
+  // and candidate pairs after each round
+  size_t stall = 0, lastGroups = 0, lastPairs = 0;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+  for (int t = 0; _simStallRounds || t < repeatT; ++t) {
+    // word k of PI i in round t is word ((t*col + i-1)*_simWords + k) of
+    // the stream, whichever thread generates it; PIs with a biased
+    // weight (see cirWeight.cpp) draw from a stream of their own
+    const ull base = (ull)t * col * _simWords;
+    const size_t T = _simPool.size();
+    const vector<unsigned char>* set =
+      _wgtOn? &_wgtSet[t % _wgtSet.size()]: 0;
+    if (set && count(set->begin(), set->end(), 8) != col) ++_wgtBiased;
+    _simPool.run([&](size_t th) {
+      int i0 = 1 + col * th / T, i1 = col * (th + 1) / T;
+      for (int i = i0; i <= i1; ++i) {
+        ull* v = simValue(CirCuit[i]->gateId);
+        ull n = base + (ull)(i - 1) * _simWords;
+        if (set && (*set)[i - 1] != 8)
+          wgtFill(*set, i - 1, v, n);
+        else for (size_t k = 0; k < _simWords; ++k)
+          v[k] = rng(n + k);
       }
-    }
+    });
+    simulate();
+    // automatic sets cycle uniform, mild, strong; both biased sets are
+    // derived from the uniform round just simulated
+    if (_wgtAuto && t % _wgtSet.size() == 0)
+      wgtFeedback();
+
+    simBatchDone(width);
+    if (!_simStallRounds) continue;
+
+    size_t groups = _fecClass.size(), pairs = _fecPairs;
+    bool refined = t == 0 || groups != lastGroups || pairs != lastPairs;
+    stall = refined? 0: stall + 1;
+    lastGroups = groups;
+    lastPairs = pairs;
+    cout << "Round " << t + 1 << ": " << groups << " FEC groups, " << pairs
+         << " candidate pairs" << (refined? "": " (no refinement)") << endl;
+
+    double secs = chrono::duration<double>(chrono::steady_clock::now()
+                                           - start).count();
+    if (stall >= _simStallRounds)
+      cout << "Stopped: no refinement in " << stall << " rounds." << endl;
+    else if (_simMaxPatterns && (size_t)patternNum >= _simMaxPatterns)
+      cout << "Stopped: pattern budget reached." << endl;
+    else if (_simTimeout && secs >= _simTimeout)
+      cout << "Stopped: time budget reached." << endl;
+    else continue;
+    break;
+  }
 
-    for (int i = 1; i <= MILOA[1]; ++i) {
-      CirCuit[i]->gateValue = bitset<PatternSIZE>(fi[i - 1]);
+  if (_wgtOn)
+    cout << "Weights: " << _wgtSet.size() << " sets"
+         << (_wgtAuto? " from signal probabilities": "") << ", "
+         << _wgtBiased << " of " << patternNum / width
+         << " rounds biased." << endl;
+  simEnd();
+}
+
+// Apply all 2^n input patterns (n = number of PIs, or of the PIs in the
+// -Cone; the others stay 0) with the projection patterns: bit p of the
+// i-th PI is bit i of p. PIs 0..5 repeat within a word, and PI i >= 6 is
+// all 0s or all 1s in word w by bit i-6 of w. If there are fewer patterns
+// than bits in a round, the extra bits repeat them.
+// The resulting FEC groups are exact (see fraig()).
+bool
+CirMgr::exhaustiveSim()
+{
+  static const ull proj[6] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+  };
+  // checked before simBegin(), so that the FEC groups stay untouched
+  int col = simConePINum();
+  if (col > maxExhaustivePI) {
+    cerr << "Error: Exhaustive simulation supports at most "
+         << maxExhaustivePI << " inputs (" << col << " in "
+         << (_simConeOn? "the cone": "a circuit") << ")!!" << endl;
+    return false;
+  }
+  simBegin();
+  vector<ull*> pi;
+  for (int i = 1; i <= MILOA[1]; ++i) {
+    unsigned gid = CirCuit[i]->gateId;
+    memset(simValue(gid), 0, _simWords * sizeof(ull));
+    if (!_simConeOn || _simConeMark[gid]) pi.push_back(simValue(gid));
+  }
+  assert(pi.size() == (size_t)col);
+
+  const size_t W = _simWords;
+  const ull total = 1ULL << col;
+  const ull totalWords = col > 6? total / 64: 1;
+  for (ull w0 = 0; w0 < totalWords; w0 += W) {
+    for (int i = 0; i < col; ++i) {
+      ull* v = pi[i];
+      for (size_t k = 0; k < W; ++k)
+        v[k] = i < 6? proj[i]: -(((w0 + k) % totalWords) >> (i - 6) & 1);
     }
     simulate();
 
-    if (_simLog)
-        simOutput(fi);
+    ull left = total - w0 * 64;
+    int bi = left < W * 64? left: W * 64;
+    simBatchDone(bi);
   }
 
-  fecGroupBetter();
-  fecGroupSort_ReId();
-  setFecIdx();
+  simEnd(true);
+  return true;
 }
 
-void
-CirMgr::fileSim(ifstream& patternFile)
+// The pattern file is mapped and validated as a whole first, so that a
+// bad pattern leaves the FEC groups untouched. ASCII patterns are then
+// transposed batch by batch straight from the mapped chars into 64-bit
+// words per PI; packed pattern files (see packPatterns()) already hold
+// the words and are fed to the simulator as they are. Return false after
+// printing an error if the file cannot be opened or is bad.
+bool
+CirMgr::fileSim(const string& fileName)
 {
-  int col = MILOA[1]; // row = PatternSIZE
-  patternNum = 0;
-  zero.reset();
-  string tmp;
-  string fi[col]; // try directlty stored in bitset
-
-  // check pattern length
-  patternFile >> tmp;
-  if (tmp.length() != MILOA[1]) {
-    cout << "Error: Pattern(" << tmp << ") length(" << tmp.length() <<
-            ") does not match the number of inputs(" << MILOA[1] << 
-            ") in a circuit!!" << endl;
-    return;
+  MyMmapFile mf;
+  if (!mf.open(fileName)) {
+    cerr << "Cannot open file \"" << fileName << "\"!!" << endl;
+    return false;
   }
-  // read in pattern(s)
-  int bi = 0;
-  while(true) {
-    if (patternFile.eof()) break;
-    for (int j = 0; j < col; ++j) {
-      if((char)tmp[j] != '0' && (char)tmp[j] != '1') {
-        cout << "Error: Pattern(" << tmp <<
-        ") contains a non-0/1 character('" << (char)tmp[j] << "')." << endl;
-        return;
-      }
-      fi[j] += (char)tmp[j];
-      
+
+  int col = MILOA[1];
+  const size_t nWords = _simWords;
+  const int width = nWords * 64;
+  const bool packed = isPackedPattern(mf);
+  PatHeader h;
+  size_t piWords = 0;
+  if (packed) {
+    memcpy(&h, mf.begin(), sizeof(h));
+    if (h.version != patVersion) {
+      cerr << "Error: Unsupported pattern file version " << h.version
+           << "!!" << endl;
+      return false;
+    }
+    if (h.numPI != (unsigned)col) {
+      cerr << "Error: Pattern file has " << h.numPI << " inputs, but the "
+           << "number of inputs in a circuit is " << col << "!!" << endl;
+      return false;
     }
-    patternFile >> tmp;
-    ++patternNum;
-    ++bi;
-
-    // pattern full
-    if (bi >= PatternSIZE) {
-      for (int i = 1; i <= col; ++i) {
-        CirCuit[i]->gateValue = bitset<PatternSIZE>(fi[i - 1]);
+    piWords = (h.numPattern + 63) / 64;
+    if ((mf.size() - sizeof(h)) / 8 / (col? col: 1) < piWords) {
+      cerr << "Error: Pattern file \"" << fileName << "\" is truncated!!"
+           << endl;
+      return false;
+    }
+  }
+  else if (validatePatterns(mf.begin(), mf.end(), col) < 0)
+    return false;
+
+  simBegin();
+  if (packed) {
+    const ull* words = (const ull*)(mf.begin() + sizeof(h));
+    for (size_t w0 = 0; w0 < piWords; w0 += nWords) {
+      size_t nw = piWords - w0 < nWords? piWords - w0: nWords;
+      uint64_t left = h.numPattern - w0 * 64;
+      int bi = left < (uint64_t)width? left: width;
+      for (int i = 0; i < col; ++i) {
+        ull* v = simValue(CirCuit[i + 1]->gateId);
+        memcpy(v, words + i * piWords + w0, nw * 8);
+        memset(v + nw, 0, (nWords - nw) * 8);
+        if (bi % 64) v[bi / 64] &= (1ULL << (bi % 64)) - 1;
       }
       simulate();
-        if (_simLog)
-      simOutput(fi);
+      simBatchDone(bi);
+    }
+  }
+  else {
+    // simulate batch by batch
+    const char *p = mf.begin(), *end = mf.end(), *tok;
+    size_t len;
+    vector<const char*> rows(64);
+    vector<ull> piWords((size_t)col * nWords);
+    for (bool more = true; more; ) {
+      int bi = 0;
+      fill(piWords.begin(), piWords.end(), 0ULL);
+      for (size_t w = 0; w < nWords && more; ++w) {
+        size_t nRows = 0;
+        while (nRows < 64 && (more = nextToken(p, end, tok, len)))
+          rows[nRows++] = tok;
+        transposePatterns(rows.data(), nRows, col, &piWords[w], nWords);
+        bi += nRows;
+      }
+      if (bi == 0 && patternNum > 0) break;
 
-      // reset fi
-      for (int f = 0; f < col; ++f)
-        fi[f] = "";
-      bi = 0;
+      for (int i = 1; i <= col; ++i)
+        memcpy(simValue(CirCuit[i]->gateId), &piWords[(i - 1) * nWords],
+               nWords * sizeof(ull));
+      simulate();
+      simBatchDone(bi);
     }
   }
 
-  for (int i = 1; i <= MILOA[1]; ++i) {
-    CirCuit[i]->gateValue = bitset<PatternSIZE>(fi[i - 1]);
+  simEnd();
+  return true;
+}
+
+// Set the number of patterns simulated at once (a multiple of 64)
+void
+CirMgr::setSimWidth(size_t width)
+{
+  assert(width > 0 && width % 64 == 0);
+  if (width / 64 == _simWords) return;
+  freeSimArena();
+  _simWords = width / 64;
+}
+
+// (Re)allocate the value arena if the circuit has grown or the width has
+// changed. Values are gateId-indexed, _simWords words each; every value
+// starts out as all 0, which is also what CONST and UNDEF gates keep.
+void
+CirMgr::initSimArena()
+{
+  size_t numGates = MILOA[0] + MILOA[3] + 1;
+  if (!_simArena || numGates > _simArenaGates) {
+    freeSimArena();
+    _simArena = allocSimWords((numGates + 1) * _simWords);
+    _simArenaGates = numGates;
+    // the last slot is scratch space
+    _simScratch = _simArena + numGates * _simWords;
   }
-  simulate();
-  if (_simLog)
-      simOutput(fi);
+  // the 0 plane of three-valued simulation
+  if (_simX && !_simZeroArena)
+    _simZeroArena = allocSimWords((_simArenaGates + 1) * _simWords);
+}
+
+void
+CirMgr::freeSimArena()
+{
+  _simPiPrev.clear();
+  free(_simArena);
+  free(_simZeroArena);
+  _simArena = _simScratch = _simZeroArena = 0;
+  _simArenaGates = 0;
+}
+
+// Only log the patterns whose PO values differ from the text log
+// "refLog" in the following simulation; "" turns the comparison off.
+bool
+CirMgr::setSimLogRef(const string& refLog)
+{
+  _simLogDiffNum = 0;
+  if (refLog.empty()) {
+    _simLogRef.close();
+    return true;
+  }
+  if (!_simLogRef.open(refLog))
+    return false;
+  _simLogRefPos = _simLogRef.begin();
+  return true;
+}
+
+// Convert an ASCII pattern file into the packed format read by fileSim().
+// The number of PIs is taken from the first pattern.
+bool
+CirMgr::packPatterns(const string& asciiFile, const string& packedFile)
+{
+  MyMmapFile mf;
+  if (!mf.open(asciiFile)) {
+    cerr << "Cannot open file \"" << asciiFile << "\"!!" << endl;
+    return false;
+  }
+  int col = -1;
+  long long n = validatePatterns(mf.begin(), mf.end(), col);
+  if (n < 0)
+    return false;
 
-  fecGroupBetter();
-  fecGroupSort_ReId();
-  setFecIdx();
+  size_t piWords = (n + 63) / 64;
+  vector<ull> words((size_t)col * piWords, 0ULL);
+  const char *p = mf.begin(), *end = mf.end(), *tok;
+  size_t len;
+  vector<const char*> rows(64);
+  for (size_t w = 0; w < piWords; ++w) {
+    size_t nRows = 0;
+    while (nRows < 64 && nextToken(p, end, tok, len))
+      rows[nRows++] = tok;
+    transposePatterns(rows.data(), nRows, col, &words[w], piWords);
+  }
+
+  PatHeader h;
+  memcpy(h.magic, patMagic, sizeof(patMagic));
+  h.version = patVersion;
+  h.numPI = col;
+  h.numPattern = n;
+  ofstream ofs(packedFile.c_str(), ios::out | ios::binary);
+  if (!ofs) {
+    cerr << "Cannot open file \"" << packedFile << "\"!!" << endl;
+    return false;
+  }
+  ofs.write((const char*)&h, sizeof(h));
+  ofs.write((const char*)words.data(), words.size() * sizeof(ull));
+  if (!ofs) {
+    cerr << "Error: Failed to write file \"" << packedFile << "\"!!"
+         << endl;
+    return false;
+  }
+  cout << n << " patterns of " << col << " inputs packed into \""
+       << packedFile << "\"." << endl;
+  return true;
 }
 
 /*************************************************/
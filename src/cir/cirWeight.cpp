@@ -0,0 +1,200 @@
+/****************************************************************************
+  FileName     [ cirWeight.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define weighted random pattern generation ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+// Uniform random patterns rarely set the output of a wide AND (or clear
+// that of a wide OR), so the gates behind it stay constant and their FEC
+// classes are only split by SAT. With CIRSIMulate -Random -WEights, each
+// PI is 1 with its own probability, a multiple of 1/16, and randomSim()
+// cycles through a list of such weight sets, one set per round:
+//
+//    from a file     one set per line, a probability in [0, 1] per PI in
+//                    PI order; '#' starts a comment
+//    automatically   a uniform set, then a mild and a strong set both
+//                    derived from the signal probabilities of that
+//                    uniform round (see wgtFeedback()), and so on
+//
+// A biased word is built from up to 4 uniform words: for P(1) = c/16
+// (c odd after removing the trailing zero bits, c = 0.b1b2..bm in
+// binary), start from a uniform word for bm and go up, OR-ing in a fresh
+// word for a 1 bit (p -> 1/2 + p/2) and AND-ing one for a 0 bit
+// (p -> p/2).
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+static const unsigned char wgtUniform = 8;
+// a class is a target if one of its values shows up in fewer than
+// 1/wgtRare of the patterns
+static const int wgtRare = 64;
+
+static inline ull
+biasedWord(unsigned c, const RandomWordGen& rng, ull n)
+{
+   if (c == 0) return 0;
+   if (c >= 16) return ~0ULL;
+   int m = 4;
+   while (!(c & 1)) { c >>= 1; --m; }
+   ull x = rng(n);
+   for (int j = 1; j < m; ++j) {
+      ull r = rng(n + j);
+      x = (c >> j) & 1? r | x: r & x;
+   }
+   return x;
+}
+
+/***********************************************************/
+/*   Public member functions about weighted random patterns  */
+/***********************************************************/
+// Return false after printing an error if "file" is bad
+bool
+CirMgr::setSimWeights(bool w, const string& file)
+{
+   _wgtOn = w;
+   _wgtAuto = w && file.empty();
+   _wgtSet.clear();
+   _wgtBiased = 0;
+   if (!w) return true;
+   const int nPI = MILOA[1];
+   if (_wgtAuto) {
+      _wgtSet.assign(3, vector<unsigned char>(nPI, wgtUniform));
+      return true;
+   }
+
+   ifstream ifs(file.c_str());
+   string line;
+   for (size_t lineNo = 1; getline(ifs, line); ++lineNo) {
+      size_t c = line.find('#');
+      if (c != string::npos) line.erase(c);
+      istringstream iss(line);
+      vector<unsigned char> set;
+      string tok;
+      while (iss >> tok) {
+         char* end;
+         double p = strtod(tok.c_str(), &end);
+         if (*end || !(p >= 0 && p <= 1)) {
+            cerr << "Error: Illegal weight \"" << tok << "\" in line "
+                 << lineNo << " of \"" << file << "\"!!" << endl;
+            _wgtOn = false;
+            return false;
+         }
+         set.push_back((unsigned char)lround(p * 16));
+      }
+      if (set.empty()) continue;
+      if (set.size() != (size_t)nPI) {
+         cerr << "Error: Weight set in line " << lineNo << " has "
+              << set.size() << " weights, but the number of inputs in a "
+              << "circuit is " << nPI << "!!" << endl;
+         _wgtOn = false;
+         return false;
+      }
+      _wgtSet.push_back(set);
+   }
+   if (_wgtSet.empty()) {
+      cerr << "Error: No weight set in \"" << file << "\"!!" << endl;
+      _wgtOn = false;
+      return false;
+   }
+   return true;
+}
+
+/************************************************************/
+/*   Private member functions about weighted random patterns  */
+/************************************************************/
+// Derive the mild and strong weight sets from the last round, which is
+// the uniform one. Every member of a class whose value is rare (see
+// wgtRare) votes for its rare value, and the votes flow back to the PIs
+// in reverse topological order: a vote for an AIG to be 1 goes half to each fanin literal being
+// 1, and one for it to be 0 is shared by the fanin literals being 0 in
+// proportion to how often each of them is 0 (the easier one to change
+// gets more). The votes are conserved, so they never overflow. A PI is
+// then 1 with the fraction of its votes for 1, rounded to 1/16 (strong,
+// within [1/16, 15/16]) or to 1/4 (mild, within [1/4, 3/4]); a PI with
+// no votes stays uniform.
+void
+CirMgr::wgtFeedback()
+{
+   const size_t W = _simWords, nGate = _aigType.size();
+   const double N = W * 64;
+   vector<double> vote(2 * nGate, 0.0);   // [2*gid + v]: for gid to be v
+   vector<float> prob(nGate, -1.0f);      // P(1), measured on demand
+   auto p1 = [&](unsigned gid) {
+      if (prob[gid] < 0) {
+         const ull* v = simValue(gid);
+         size_t ones = 0;
+         for (size_t k = 0; k < W; ++k)
+            ones += __builtin_popcountll(v[k]);
+         prob[gid] = ones / N;
+      }
+      return prob[gid];
+   };
+
+   for (const FecClass& c : _fecClass) {
+      const unsigned* mem = &_fecLit[c.first];
+      double p = p1(mem[0] >> 1);
+      if ((p < 0.5? p: 1 - p) * wgtRare >= 1) continue;
+      bool rare = p < 0.5;   // for mem[0]
+      for (unsigned i = 0; i < c.second; ++i) {
+         unsigned gid = mem[i] >> 1;
+         if (_aigType[gid] == AIG_GATE)
+            vote[2 * gid + (rare ^ ((mem[i] ^ mem[0]) & 1))] += 1;
+      }
+   }
+
+   for (size_t i = _aigOrder.size(); i-- > 0; ) {
+      unsigned gid = _aigOrder[i];
+      double v0 = vote[2 * gid], v1 = vote[2 * gid + 1];
+      if (v0 == 0 && v1 == 0) continue;
+      // vote[lit]: for the literal to be 0; vote[lit ^ 1]: to be 1
+      unsigned la = _aigFanin[2 * gid], lb = _aigFanin[2 * gid + 1];
+      vote[la ^ 1] += v1 / 2;
+      vote[lb ^ 1] += v1 / 2;
+      if (v0 == 0) continue;
+      double qa = la & 1? p1(la >> 1): 1 - p1(la >> 1);
+      double qb = lb & 1? p1(lb >> 1): 1 - p1(lb >> 1);
+      double sa = qa + qb > 0? qa / (qa + qb): 0.5;
+      vote[la] += v0 * sa;
+      vote[lb] += v0 * (1 - sa);
+   }
+
+   for (int i = 0; i < MILOA[1]; ++i) {
+      unsigned gid = CirCuit[i + 1]->gateId;
+      double v0 = vote[2 * gid], v1 = vote[2 * gid + 1];
+      unsigned char mild = wgtUniform, strong = wgtUniform;
+      if (v0 + v1 > 0) {
+         double p = v1 / (v0 + v1);
+         long s = lround(p * 16), m = 4 * lround(p * 4);
+         strong = s < 1? 1: s > 15? 15: s;
+         mild = m < 4? 4: m > 12? 12: m;
+      }
+      _wgtSet[1][i] = mild;
+      _wgtSet[2][i] = strong;
+   }
+}
+
+// Fill the words of the i-th PI (from 0) by its weight in "set"; "n" is
+// the index of its first word in the pattern stream (see randomSim())
+void
+CirMgr::wgtFill(const vector<unsigned char>& set, int i, ull* v, ull n) const
+{
+   RandomWordGen rng(~_simSeed);
+   for (size_t k = 0; k < _simWords; ++k)
+      v[k] = biasedWord(set[i], rng, (n + k) * 4);
+}
@@ -0,0 +1,22 @@
+util.d: ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h ../../include/myHashMap.h ../../include/myMmap.h ../../include/myPool.h ../../include/myThread.h 
+../../include/util.h: util.h
+	@rm -f ../../include/util.h
+	@ln -fs ../src/util/util.h ../../include/util.h
+../../include/rnGen.h: rnGen.h
+	@rm -f ../../include/rnGen.h
+	@ln -fs ../src/util/rnGen.h ../../include/rnGen.h
+../../include/myUsage.h: myUsage.h
+	@rm -f ../../include/myUsage.h
+	@ln -fs ../src/util/myUsage.h ../../include/myUsage.h
+../../include/myHashMap.h: myHashMap.h
+	@rm -f ../../include/myHashMap.h
+	@ln -fs ../src/util/myHashMap.h ../../include/myHashMap.h
+../../include/myMmap.h: myMmap.h
+	@rm -f ../../include/myMmap.h
+	@ln -fs ../src/util/myMmap.h ../../include/myMmap.h
+../../include/myPool.h: myPool.h
+	@rm -f ../../include/myPool.h
+	@ln -fs ../src/util/myPool.h ../../include/myPool.h
+../../include/myThread.h: myThread.h
+	@rm -f ../../include/myThread.h
+	@ln -fs ../src/util/myThread.h ../../include/myThread.h
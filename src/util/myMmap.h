@@ -0,0 +1,61 @@
+/****************************************************************************
+  FileName     [ myMmap.h ]
+  PackageName  [ util ]
+  Synopsis     [ Read-only memory-mapped file ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef MY_MMAP_H
+#define MY_MMAP_H
+
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+// Map a whole file read-only into memory so that parsers can scan the
+// bytes directly, without going through iostream buffers.
+// An empty file is mapped to an empty (but valid) range.
+class MyMmapFile
+{
+public:
+   MyMmapFile() : _data(0), _size(0), _mapped(false) {}
+   ~MyMmapFile() { close(); }
+
+   bool open(const string& fileName) {
+      close();
+      int fd = ::open(fileName.c_str(), O_RDONLY);
+      if (fd < 0) return false;
+      struct stat st;
+      if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+      _size = st.st_size;
+      if (_size == 0) { ::close(fd); _data = ""; return true; }
+      void *p = mmap(0, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+      ::close(fd);
+      if (p == MAP_FAILED) { _size = 0; return false; }
+      madvise(p, _size, MADV_SEQUENTIAL);
+      _data = (const char*)p;
+      _mapped = true;
+      return true;
+   }
+   void close() {
+      if (_mapped) munmap((void*)_data, _size);
+      _data = 0; _size = 0; _mapped = false;
+   }
+
+   bool isOpen() const { return _data != 0; }
+   const char* begin() const { return _data; }
+   const char* end() const { return _data + _size; }
+   size_t size() const { return _size; }
+
+private:
+   const char   *_data;
+   size_t        _size;
+   bool          _mapped;
+};
+
+#endif // MY_MMAP_H
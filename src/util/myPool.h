@@ -0,0 +1,75 @@
+/****************************************************************************
+  FileName     [ myPool.h ]
+  PackageName  [ util ]
+  Synopsis     [ Slab allocator with a free list for fixed-size objects ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef MY_POOL_H
+#define MY_POOL_H
+
+#include <vector>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+using namespace std;
+
+// Objects are carved out of large slabs; freed objects go to a free list
+// and are handed out again by the next alloc(). Slabs are only returned
+// to the system all at once, by release() or the destructor, so the
+// objects must have been free()-ed (destructed) before that.
+template <class T>
+class MyPool
+{
+   union Slot {
+      Slot                                              *_next;
+      typename aligned_storage<sizeof(T), alignof(T)>::type _data;
+   };
+
+public:
+   MyPool(size_t slabSize = 4096)
+      : _slabSize(slabSize), _freeList(0), _cur(0), _left(0) {}
+   ~MyPool() { release(); }
+
+   template <class... Args>
+   T* alloc(Args&&... args) {
+      Slot *s;
+      if (_freeList) { s = _freeList; _freeList = s->_next; }
+      else {
+         if (_left == 0) newSlab(_slabSize);
+         s = _cur++; --_left;
+      }
+      return new (s) T(std::forward<Args>(args)...);
+   }
+   void free(T* t) {
+      if (!t) return;
+      t->~T();
+      Slot *s = reinterpret_cast<Slot*>(t);
+      s->_next = _freeList;
+      _freeList = s;
+   }
+   // make sure the next n alloc() calls do not need a new slab
+   void reserve(size_t n) { if (_left < n) newSlab(n); }
+   void release() {
+      for (Slot *slab : _slabs) ::operator delete(slab);
+      _slabs.clear();
+      _freeList = _cur = 0; _left = 0;
+   }
+
+private:
+   size_t         _slabSize;
+   vector<Slot*>  _slabs;
+   Slot          *_freeList;
+   Slot          *_cur;
+   size_t         _left;
+
+   void newSlab(size_t n) {
+      _cur = static_cast<Slot*>(::operator new(n * sizeof(Slot)));
+      _slabs.push_back(_cur);
+      _left = n;
+   }
+};
+
+#endif // MY_POOL_H
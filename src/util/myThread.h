@@ -0,0 +1,112 @@
+/****************************************************************************
+  FileName     [ myThread.h ]
+  PackageName  [ util ]
+  Synopsis     [ A small fork-join thread pool ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef MY_THREAD_H
+#define MY_THREAD_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+using namespace std;
+
+// The workers are started once (resize()) and then sleep between jobs,
+// so that run() can be called for every simulation round at little cost.
+// run(f) calls f(0) .. f(size()-1) in parallel, f(0) on the calling
+// thread, and returns when all of them are done.
+class MyThreadPool
+{
+public:
+   MyThreadPool() : _job(0), _gen(0), _busy(0), _stop(false) {}
+   ~MyThreadPool() { resize(1); }
+
+   size_t size() const { return _workers.size() + 1; }
+   void resize(size_t n) {
+      if (n < 1) n = 1;
+      if (n == size()) return;
+      {
+         lock_guard<mutex> lk(_mtx);
+         _stop = true;
+      }
+      _wakeCv.notify_all();
+      for (thread& t : _workers) t.join();
+      _workers.clear();
+      _stop = false;
+      for (size_t i = 1; i < n; ++i)
+         _workers.push_back(thread(&MyThreadPool::work, this, i, _gen));
+   }
+   void run(const function<void(size_t)>& f) {
+      if (_workers.empty()) { f(0); return; }
+      {
+         lock_guard<mutex> lk(_mtx);
+         _job = &f;
+         _busy = _workers.size();
+         ++_gen;
+      }
+      _wakeCv.notify_all();
+      f(0);
+      unique_lock<mutex> lk(_mtx);
+      _doneCv.wait(lk, [this] { return _busy == 0; });
+      _job = 0;
+   }
+
+private:
+   vector<thread>                    _workers;
+   mutex                             _mtx;
+   condition_variable                _wakeCv;
+   condition_variable                _doneCv;
+   const function<void(size_t)>     *_job;
+   size_t                            _gen;
+   size_t                            _busy;
+   bool                              _stop;
+
+   void work(size_t idx, size_t seen) {
+      while (true) {
+         const function<void(size_t)> *job;
+         {
+            unique_lock<mutex> lk(_mtx);
+            _wakeCv.wait(lk, [&] { return _stop || _gen != seen; });
+            if (_stop) return;
+            seen = _gen;
+            job = _job;
+         }
+         (*job)(idx);
+         lock_guard<mutex> lk(_mtx);
+         if (--_busy == 0) _doneCv.notify_one();
+      }
+   }
+};
+
+// Barrier for the threads of one MyThreadPool::run() call. Waiting is a
+// short spin with yield(), since the phases it separates are short.
+class MyBarrier
+{
+public:
+   MyBarrier(size_t n) : _n(n), _count(0), _gen(0) {}
+
+   void wait() {
+      size_t gen = _gen.load(memory_order_acquire);
+      if (_count.fetch_add(1, memory_order_acq_rel) + 1 == _n) {
+         _count.store(0, memory_order_relaxed);
+         _gen.fetch_add(1, memory_order_release);
+      }
+      else
+         while (_gen.load(memory_order_acquire) == gen)
+            this_thread::yield();
+   }
+
+private:
+   size_t           _n;
+   atomic<size_t>   _count;
+   atomic<size_t>   _gen;
+};
+
+#endif // MY_THREAD_H
@@ -26,5 +26,26 @@ class RandomNumGen
       }
 };
 
+// Counter-based generator of 64-bit words: word n of the stream for a
+// seed only depends on (seed, n), so words can be generated in any order
+// or by several threads and still be reproduced from the seed.
+// Word n is the SplitMix64 finalizer of the n-th Weyl sequence element.
+class RandomWordGen
+{
+   public:
+      RandomWordGen(unsigned long long seed = 0) : _key(mix(seed)) {}
+      unsigned long long operator() (unsigned long long n) const {
+         return mix(_key + n * 0x9E3779B97F4A7C15ULL);
+      }
+
+   private:
+      unsigned long long _key;
+      static unsigned long long mix(unsigned long long z) {
+         z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+         z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+         return z ^ (z >> 31);
+      }
+};
+
 #endif // RN_GEN_H
 